@@ -0,0 +1,491 @@
+// Microbenchmarks for the engine hot paths on synthetic maps.
+//
+// Usage: JourneyToTheCloudsBench [--max-size <tiles>] [--jobs <n>]
+//                                [--json <file>]
+//
+// Every benchmark reports ns/op, heap allocations/op and throughput.
+// With --json the results are also written as a JSON array so they can be
+// compared between releases.
+
+#include "Core/JobSystem.hpp"
+#include "Entities/EntityWorld.hpp"
+#include "Graphics/ParticleEmitter.hpp"
+#include "World/Map.hpp"
+#include "World/SpatialHash.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Allocation counting
+// Every global allocation in the process goes through these replacements.
+
+static std::atomic<std::uint64_t> gAllocations{0};
+
+void *operator new(std::size_t size) {
+  gAllocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size ? size : 1))
+    return ptr;
+  throw std::bad_alloc();
+}
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete[](void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+namespace {
+
+struct Result {
+  std::string name;
+  int mapSize = 0;
+  std::uint64_t iterations = 0;
+  double nsPerOp = 0.0;
+  double allocsPerOp = 0.0;
+  double itemsPerSec = 0.0;
+  std::string itemUnit;
+};
+
+// Discards std::cout output (Map logs every load) while alive
+class QuietCout {
+public:
+  QuietCout() : mPrevious(std::cout.rdbuf(nullptr)) {}
+  ~QuietCout() { std::cout.rdbuf(mPrevious); }
+
+private:
+  std::streambuf *mPrevious;
+};
+
+// Keeps results alive so the optimizer can't drop the measured work
+std::uint64_t gSink = 0;
+
+// Runs op() in growing batches until at least minTime has passed.
+// itemsPerOp is the amount of work (bytes, tiles, queries) in one op.
+template <typename Op>
+Result measure(const std::string &name, int mapSize, double itemsPerOp,
+               const std::string &itemUnit, Op &&op) {
+  using Clock = std::chrono::steady_clock;
+  const auto minTime = std::chrono::milliseconds(200);
+
+  op(); // Warm up caches and lazily sized buffers
+
+  std::uint64_t batch = 1;
+  std::uint64_t iterations = 0;
+  std::uint64_t allocations = 0;
+  Clock::duration elapsed{};
+
+  while (elapsed < minTime) {
+    std::uint64_t allocsBefore = gAllocations.load();
+    auto start = Clock::now();
+    for (std::uint64_t i = 0; i < batch; ++i) {
+      gSink += static_cast<std::uint64_t>(op());
+    }
+    elapsed += Clock::now() - start;
+    allocations += gAllocations.load() - allocsBefore;
+    iterations += batch;
+    batch *= 2;
+  }
+
+  double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+
+  Result result;
+  result.name = name;
+  result.mapSize = mapSize;
+  result.iterations = iterations;
+  result.nsPerOp = ns / iterations;
+  result.allocsPerOp = static_cast<double>(allocations) / iterations;
+  result.itemsPerSec = itemsPerOp * iterations / (ns * 1e-9);
+  result.itemUnit = itemUnit;
+  return result;
+}
+
+// Small deterministic generator so every run uses the same maps
+class Lcg {
+public:
+  explicit Lcg(std::uint32_t seed) : mState(seed) {}
+  std::uint32_t next() {
+    mState = mState * 1664525u + 1013904223u;
+    return mState >> 8;
+  }
+  int range(int lo, int hi) {
+    return lo + static_cast<int>(next() % (hi - lo));
+  }
+
+private:
+  std::uint32_t mState;
+};
+
+// Main layer of a synthetic level: solid border, random platforms every
+// few rows, spawn near the top-left, finish near the bottom-right
+std::vector<int> makeMainLayer(int size) {
+  std::vector<int> tiles(static_cast<size_t>(size) * size, 0);
+  Lcg rng(1234u + size);
+
+  for (int i = 0; i < size; ++i) {
+    tiles[i] = 3;
+    tiles[static_cast<size_t>(size - 1) * size + i] = 3;
+    tiles[static_cast<size_t>(i) * size] = 3;
+    tiles[static_cast<size_t>(i) * size + size - 1] = 3;
+  }
+  for (int y = 6; y < size - 1; y += 6) {
+    for (int x = 1; x < size - 1;) {
+      int length = rng.range(3, 9);
+      bool solid = rng.next() % 3 != 0;
+      for (int i = 0; i < length && x < size - 1; ++i, ++x) {
+        if (solid)
+          tiles[static_cast<size_t>(y) * size + x] = 3;
+      }
+    }
+  }
+
+  tiles[static_cast<size_t>(2) * size + 2] = 1;
+  tiles[static_cast<size_t>(size - 2) * size + size - 3] = 2;
+  return tiles;
+}
+
+std::string toCSV(const std::vector<int> &tiles, int size) {
+  std::string csv = "\n";
+  csv.reserve(tiles.size() * 3);
+  for (int y = 0; y < size; ++y) {
+    for (int x = 0; x < size; ++x) {
+      csv += std::to_string(tiles[static_cast<size_t>(y) * size + x]);
+      if (y != size - 1 || x != size - 1)
+        csv += ',';
+    }
+    csv += '\n';
+  }
+  return csv;
+}
+
+std::string makeTMX(int size, const std::string &mainCSV,
+                    const std::string &textureCSV) {
+  std::ostringstream tmx;
+  tmx << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+      << "<map version=\"1.10\" orientation=\"orthogonal\" width=\"" << size
+      << "\" height=\"" << size
+      << "\" tilewidth=\"32\" tileheight=\"32\" infinite=\"0\">\n"
+      << " <tileset firstgid=\"1\" name=\"MainTileset\" tilewidth=\"32\""
+      << " tileheight=\"32\" tilecount=\"6\" columns=\"6\">\n"
+      << "  <image source=\"" << Map::TILESET_IMAGE
+      << "\" width=\"192\" height=\"32\"/>\n";
+  // Same tile types as assets/tilesets/tileset.tsx
+  const char *properties[] = {"spawn", "finish", "solid",
+                              "render", "render", "render"};
+  for (int id = 0; id < 6; ++id) {
+    tmx << "  <tile id=\"" << id << "\"><properties><property name=\""
+        << properties[id] << "\" type=\"bool\" value=\"true\"/>"
+        << "</properties></tile>\n";
+  }
+  tmx << " </tileset>\n"
+      << " <layer id=\"1\" name=\"main\" width=\"" << size << "\" height=\""
+      << size << "\">\n  <data encoding=\"csv\">" << mainCSV
+      << "</data>\n </layer>\n"
+      << " <objectgroup id=\"2\" name=\"text\">\n";
+  for (int i = 0; i < 8; ++i) {
+    tmx << "  <object id=\"" << 10 + i << "\" name=\"sign\" x=\""
+        << 64 * (i + 1) << "\" y=\"96\" width=\"120\" height=\"19\">\n"
+        << "   <text wrap=\"1\">synthetic sign number " << i << "</text>\n"
+        << "  </object>\n";
+  }
+  tmx << " </objectgroup>\n"
+      << " <layer id=\"3\" name=\"textures\" width=\"" << size
+      << "\" height=\"" << size << "\">\n  <data encoding=\"csv\">"
+      << textureCSV << "</data>\n </layer>\n</map>\n";
+  return tmx.str();
+}
+
+void printResult(const Result &r) {
+  std::cout << std::left << std::setw(22) << r.name << std::right
+            << std::setw(6) << r.mapSize << std::fixed << std::setprecision(1)
+            << std::setw(14) << r.nsPerOp << " ns/op" << std::setprecision(2)
+            << std::setw(10) << r.allocsPerOp << " allocs/op"
+            << std::scientific << std::setprecision(3) << std::setw(12)
+            << r.itemsPerSec << " " << r.itemUnit << "/s" << std::defaultfloat
+            << std::endl;
+}
+
+void writeJSON(const std::vector<Result> &results,
+               const std::string &filename) {
+  std::ofstream out(filename);
+  if (!out.is_open()) {
+    std::cerr << "Failed to write " << filename << std::endl;
+    return;
+  }
+
+  out << "[\n";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    out << "  {\"name\": \"" << r.name << "\", \"map_size\": " << r.mapSize
+        << ", \"iterations\": " << r.iterations
+        << ", \"ns_per_op\": " << r.nsPerOp
+        << ", \"allocs_per_op\": " << r.allocsPerOp
+        << ", \"items_per_sec\": " << r.itemsPerSec << ", \"item_unit\": \""
+        << r.itemUnit << "\"}" << (i + 1 < results.size() ? "," : "")
+        << "\n";
+  }
+  out << "]\n";
+}
+
+void runSuite(int size, std::vector<Result> &results) {
+  std::vector<int> mainTiles = makeMainLayer(size);
+  std::vector<int> textureTiles(mainTiles.size());
+  for (size_t i = 0; i < mainTiles.size(); ++i)
+    textureTiles[i] = mainTiles[i] == 3 ? 6 : 0;
+
+  std::string mainCSV = toCSV(mainTiles, size);
+  std::string tmx = makeTMX(size, mainCSV, toCSV(textureTiles, size));
+  double tiles = static_cast<double>(size) * size;
+
+  Map map;
+  {
+    QuietCout quiet;
+
+    results.push_back(measure("parseTMX", size, tmx.size(), "bytes", [&] {
+      return map.loadFromMemory(tmx);
+    }));
+  }
+  results.push_back(
+      measure("parseLayerData", size, tiles, "tiles", [&] {
+        return Map::parseLayerData(mainCSV, size, size).size();
+      }));
+
+  // Query boxes spread over the whole map (player sized)
+  Lcg rng(99u);
+  float worldSize = size * Map::TILE_SIZE;
+  std::vector<sf::FloatRect> queries(4096);
+  for (auto &query : queries) {
+    query = sf::FloatRect({static_cast<float>(rng.next() % 1000) / 1000.f *
+                               (worldSize - 24.f),
+                           static_cast<float>(rng.next() % 1000) / 1000.f *
+                               (worldSize - 32.f)},
+                          {24.f, 32.f});
+  }
+  size_t queryIndex = 0;
+  auto nextQuery = [&]() -> const sf::FloatRect & {
+    queryIndex = (queryIndex + 1) & (queries.size() - 1);
+    return queries[queryIndex];
+  };
+
+  results.push_back(measure("checkCollision", size, 1, "queries", [&] {
+    return map.checkCollision(nextQuery()).size();
+  }));
+  results.push_back(measure("overlapsSolid", size, 1, "queries", [&] {
+    return map.overlapsSolid(nextQuery());
+  }));
+  results.push_back(measure("sweepAABB", size, 1, "queries", [&] {
+    // Diagonal moves of up to three tiles, in every direction
+    const sf::FloatRect &query = nextQuery();
+    sf::Vector2f delta(
+        (static_cast<float>(queryIndex % 13) - 6.f) * Map::TILE_SIZE / 2.f,
+        (static_cast<float>(queryIndex % 7) - 3.f) * Map::TILE_SIZE);
+    return map.sweepAABB(query, delta).hit;
+  }));
+  results.push_back(measure("checkFinish", size, 1, "queries", [&] {
+    return map.checkFinish(nextQuery());
+  }));
+
+  // Player physics: run right, jump every second, respawn when lost
+  EntityWorld world;
+  EntityId player = world.spawn(EntityKind::Player, map.getStartPosition());
+  std::uint32_t tick = 0;
+  results.push_back(measure("player update", size, 1, "ticks", [&] {
+    PlayerInput input;
+    input.right = (tick / 240) % 2 == 0;
+    input.left = !input.right;
+    input.jump = tick % 60 < 20;
+    ++tick;
+
+    world.setInput(player, input);
+    world.update(1.f / 60.f, map);
+    if (world.getPosition(player).y > map.getHeight() + 200.f)
+      world.reset(player, map.getStartPosition());
+    return world.isOnGround(player);
+  }));
+
+  // A crowded level: 10k enemies, pickups and projectiles scattered over
+  // the map, topped up after every tick as projectiles hit walls
+  const std::size_t crowd = 10000;
+  std::uint32_t seed = 1;
+  auto spawnScattered = [&] {
+    seed = seed * 1664525u + 1013904223u;
+    sf::Vector2f position((seed >> 8) % 10000 / 10000.f * map.getWidth(),
+                          (seed >> 4) % 10000 / 10000.f * map.getHeight());
+    switch (seed >> 30) {
+    case 0:
+      world.spawn(EntityKind::Projectile, position,
+                  {(seed & 1) ? 400.f : -400.f, 0.f});
+      break;
+    case 1:
+      world.spawn(EntityKind::Pickup, position, {0.f, -200.f});
+      break;
+    default:
+      world.spawn(EntityKind::Enemy, position, {(seed & 1) ? 1.f : -1.f, 0.f});
+      break;
+    }
+  };
+  while (world.size() < crowd)
+    spawnScattered();
+  results.push_back(measure("EntityWorld 10k", size, crowd, "entities", [&] {
+    world.update(1.f / 60.f, map);
+    while (world.size() < crowd)
+      spawnScattered();
+    return world.size();
+  }));
+
+  // A full frame of particles: update then vertex build, with the
+  // expired ones replaced so the count stays at 100k
+  const std::size_t particleCount = 100000;
+  ParticleParams particleParams;
+  particleParams.lifetime = 2.f;
+  particleParams.lifetimeVariance = 1.f;
+  particleParams.gravity = 300.f;
+  particleParams.drag = 1.f;
+  ParticleEmitter particles(particleParams, particleCount);
+  sf::VertexArray particleVertices(sf::PrimitiveType::Triangles);
+  sf::Vector2f particleOrigin(size * 16.f, size * 16.f);
+  particles.emit(particleOrigin, {0.f, -1.f}, particleCount);
+  results.push_back(measure(
+      "particles 100k", size, static_cast<double>(particleCount), "particles",
+      [&] {
+        particles.update(1.f / 60.f);
+        particles.emit(particleOrigin, {0.f, -1.f},
+                       static_cast<int>(particleCount - particles.size()));
+        particles.buildVertices(particleVertices);
+        return particleVertices.getVertexCount();
+      }));
+
+  // Broadphase: one body per 32 tiles of map, so density (and pairs per
+  // body) is the same at every size and the cost should grow linearly
+  std::vector<sf::FloatRect> bodies(static_cast<size_t>(size) * size / 32);
+  Lcg bodyRng(99u + size);
+  for (sf::FloatRect &body : bodies) {
+    body.position = {static_cast<float>(bodyRng.next() % (size * 32)),
+                     static_cast<float>(bodyRng.next() % (size * 32))};
+    body.size = {static_cast<float>(bodyRng.range(8, 33)),
+                 static_cast<float>(bodyRng.range(8, 33))};
+  }
+  double bodyCount = static_cast<double>(bodies.size());
+
+  SpatialHash hash;
+  auto rebuild = [&] {
+    hash.clear();
+    for (std::uint32_t i = 0; i < bodies.size(); ++i)
+      hash.insert(i, bodies[i]);
+    hash.build();
+  };
+  results.push_back(measure("hash rebuild", size, bodyCount, "bodies", [&] {
+    rebuild();
+    return hash.size();
+  }));
+  results.push_back(measure("hash pairs", size, bodyCount, "bodies", [&] {
+    rebuild();
+    std::uint64_t pairs = 0;
+    hash.forEachPair([&](std::uint32_t, std::uint32_t) { ++pairs; });
+    return pairs;
+  }));
+  results.push_back(measure("hash query", size, 1, "queries", [&] {
+    std::uint64_t found = 0;
+    hash.query(nextQuery(), [&](std::uint32_t) { ++found; });
+    return found;
+  }));
+  results.push_back(measure("hash raycast", size, 1, "rays", [&] {
+    const sf::FloatRect &query = nextQuery();
+    sf::Vector2f direction(static_cast<float>(queryIndex % 13) - 6.f,
+                           static_cast<float>(queryIndex % 7) - 3.f);
+    return hash.raycast(query.position, direction, 1000.f).hit;
+  }));
+
+  // The all-pairs loop the hash replaces, for comparison (quadratic, so
+  // only on the small maps)
+  if (bodies.size() <= 4096) {
+    results.push_back(measure("naive pairs", size, bodyCount, "bodies", [&] {
+      std::uint64_t pairs = 0;
+      for (size_t i = 0; i < bodies.size(); ++i)
+        for (size_t j = i + 1; j < bodies.size(); ++j)
+          pairs += bodies[i].findIntersection(bodies[j]).has_value();
+      return pairs;
+    }));
+  }
+
+  // Render culling: the 640x360 camera at the query positions
+  results.push_back(measure("visibleChunks", size, 1, "views", [&] {
+    sf::View view(nextQuery().position, {640.f, 360.f});
+    sf::IntRect chunks = map.getVisibleChunks(view);
+    return chunks.size.x * chunks.size.y;
+  }));
+}
+
+void printUsage() {
+  std::cout << "Usage: JourneyToTheCloudsBench [--max-size <tiles>] "
+               "[--jobs <n>] [--json <file>]"
+            << std::endl;
+}
+
+// The whole of text as an integer above zero
+bool parsePositive(std::string_view text, int &value) {
+  int parsed = 0;
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, parsed);
+  if (result.ec != std::errc() || result.ptr != end || parsed <= 0)
+    return false;
+  value = parsed;
+  return true;
+}
+
+int invalidValue(const std::string &option, std::string_view value) {
+  std::cerr << "Invalid value for " << option << ": \"" << value << "\""
+            << std::endl;
+  printUsage();
+  return 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  int maxSize = 4096;
+  std::string jsonPath;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--max-size" && i + 1 < argc) {
+      if (!parsePositive(argv[++i], maxSize))
+        return invalidValue(arg, argv[i]);
+    } else if (arg == "--jobs" && i + 1 < argc) {
+      int threads = 0;
+      if (!parsePositive(argv[++i], threads))
+        return invalidValue(arg, argv[i]);
+      JobSystem::setInstanceWorkers(threads - 1);
+    } else if (arg == "--json" && i + 1 < argc) {
+      jsonPath = argv[++i];
+    } else {
+      printUsage();
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  std::vector<Result> results;
+  for (int size : {50, 256, 1024, 4096}) {
+    if (size > maxSize)
+      break;
+    size_t first = results.size();
+    runSuite(size, results);
+    for (size_t i = first; i < results.size(); ++i)
+      printResult(results[i]);
+  }
+
+  if (!jsonPath.empty())
+    writeJSON(results, jsonPath);
+
+  return gSink == 0xFFFFFFFFFFFFFFFFull ? 1 : 0;
+}
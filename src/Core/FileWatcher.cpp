@@ -0,0 +1,113 @@
+#include "FileWatcher.hpp"
+#include <iostream>
+
+#ifdef __linux__
+#include <cerrno>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+
+bool FileWatcher::watch(const std::string &path) {
+  stop();
+
+  mFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (mFd < 0) {
+    std::cerr << "inotify unavailable, not watching " << path << std::endl;
+    return false;
+  }
+
+  std::filesystem::path file(path);
+  std::filesystem::path folder = file.parent_path();
+  if (folder.empty())
+    folder = ".";
+
+  // Written in place, or replaced by a rename or a new file
+  mWatch = inotify_add_watch(mFd, folder.c_str(),
+                             IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+  if (mWatch < 0) {
+    std::cerr << "Failed to watch " << folder.string() << std::endl;
+    stop();
+    return false;
+  }
+
+  mPath = path;
+  mFileName = file.filename();
+  return true;
+}
+
+void FileWatcher::stop() {
+  if (mFd >= 0)
+    ::close(mFd); // Also removes the watch
+  mFd = -1;
+  mWatch = -1;
+  mPath.clear();
+  mFileName.clear();
+}
+
+bool FileWatcher::poll() {
+  if (mFd < 0)
+    return false;
+
+  // Drain every pending event; several writes between two polls (an
+  // editor saving in steps) count as one change
+  bool changed = false;
+  alignas(inotify_event) char buffer[4096];
+  while (true) {
+    ssize_t length = read(mFd, buffer, sizeof(buffer));
+    if (length <= 0)
+      break; // EAGAIN: nothing more queued
+
+    for (ssize_t offset = 0; offset < length;) {
+      const auto *event =
+          reinterpret_cast<const inotify_event *>(buffer + offset);
+      if (event->len > 0 && mFileName == event->name)
+        changed = true;
+      offset += sizeof(inotify_event) + event->len;
+    }
+  }
+  return changed;
+}
+
+#else
+
+bool FileWatcher::watch(const std::string &path) {
+  stop();
+
+  std::error_code error;
+  mLastWrite = std::filesystem::last_write_time(path, error);
+  if (error) {
+    std::cerr << "Failed to watch " << path << std::endl;
+    return false;
+  }
+  mPath = path;
+  mFileName = std::filesystem::path(path).filename();
+  mNextCheck = std::chrono::steady_clock::now();
+  return true;
+}
+
+void FileWatcher::stop() {
+  mPath.clear();
+  mFileName.clear();
+}
+
+bool FileWatcher::poll() {
+  if (mPath.empty())
+    return false;
+
+  // Asking the file system every frame would cost more than it's worth
+  auto now = std::chrono::steady_clock::now();
+  if (now < mNextCheck)
+    return false;
+  mNextCheck = now + std::chrono::milliseconds(250);
+
+  std::error_code error;
+  auto lastWrite = std::filesystem::last_write_time(mPath, error);
+  if (error || lastWrite == mLastWrite)
+    return false; // Missing while being replaced, or unchanged
+  mLastWrite = lastWrite;
+  return true;
+}
+
+#endif
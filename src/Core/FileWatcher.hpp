@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+// Notices when a file has been written, for reloading assets while the
+// game runs. Polled (never blocks), so it can be checked once a frame.
+//
+// On Linux it uses inotify on the file's folder rather than on the file:
+// editors such as Tiled save by writing a new file and renaming it over
+// the old one, which a watch on the old inode would miss. Elsewhere it
+// compares the modification time a few times a second.
+class FileWatcher {
+public:
+  FileWatcher() = default;
+  ~FileWatcher() { stop(); }
+
+  FileWatcher(const FileWatcher &) = delete;
+  FileWatcher &operator=(const FileWatcher &) = delete;
+
+  // Starts watching path (instead of any earlier file)
+  bool watch(const std::string &path);
+  void stop();
+
+  bool isWatching() const { return !mPath.empty(); }
+  const std::string &getPath() const { return mPath; }
+
+  // True if the file was written since the last call
+  bool poll();
+
+private:
+  std::string mPath;
+  std::filesystem::path mFileName;
+
+#ifdef __linux__
+  int mFd = -1;
+  int mWatch = -1;
+#else
+  std::filesystem::file_time_type mLastWrite;
+  std::chrono::steady_clock::time_point mNextCheck;
+#endif
+};
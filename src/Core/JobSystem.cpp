@@ -0,0 +1,243 @@
+#include "JobSystem.hpp"
+#include <algorithm>
+
+namespace {
+
+// Pool and queue of the current worker thread (none outside a pool)
+thread_local const JobSystem *tPool = nullptr;
+thread_local unsigned tQueue = 0;
+
+int gInstanceWorkers = -1;
+
+} // namespace
+
+bool JobSystem::Handle::isDone() const {
+  if (!mJob)
+    return true;
+  std::lock_guard<std::mutex> lock(mJob->mutex);
+  return mJob->done;
+}
+
+JobSystem::JobSystem(int workers) {
+  if (workers < 0) {
+    unsigned hardware = std::thread::hardware_concurrency();
+    workers = hardware > 1 ? static_cast<int>(hardware) - 1 : 0;
+  }
+
+  for (int i = 0; i <= workers; ++i)
+    mQueues.push_back(std::make_unique<Queue>());
+
+  mWorkers.reserve(workers);
+  for (unsigned i = 1; i <= static_cast<unsigned>(workers); ++i)
+    mWorkers.emplace_back([this, i] { workerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mStopping = true;
+  }
+  mWake.notify_all();
+  for (std::thread &worker : mWorkers)
+    worker.join();
+}
+
+JobSystem &JobSystem::instance() {
+  static JobSystem pool(gInstanceWorkers);
+  return pool;
+}
+
+void JobSystem::setInstanceWorkers(int workers) {
+  gInstanceWorkers = workers;
+}
+
+unsigned JobSystem::queueIndex() const {
+  return tPool == this ? tQueue : 0;
+}
+
+void JobSystem::workerLoop(unsigned index) {
+  tPool = this;
+  tQueue = index;
+
+  while (true) {
+    if (std::shared_ptr<Job> job = findJob(index)) {
+      run(job);
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(mWakeMutex);
+    mWake.wait(lock, [this] {
+      return mStopping || mQueued.load(std::memory_order_acquire) > 0;
+    });
+    if (mStopping)
+      return;
+  }
+}
+
+void JobSystem::push(std::shared_ptr<Job> job) {
+  Queue &queue = *mQueues[queueIndex()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  {
+    // Counted under the wake lock so a worker can't check the count and
+    // then miss the notification
+    std::lock_guard<std::mutex> lock(mWakeMutex);
+    mQueued.fetch_add(1, std::memory_order_release);
+  }
+  mWake.notify_one();
+}
+
+std::shared_ptr<JobSystem::Job> JobSystem::findJob(unsigned home) {
+  if (mQueued.load(std::memory_order_acquire) == 0)
+    return nullptr;
+
+  // Own queue first, newest job
+  {
+    Queue &queue = *mQueues[home];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.jobs.empty()) {
+      std::shared_ptr<Job> job = std::move(queue.jobs.back());
+      queue.jobs.pop_back();
+      mQueued.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+
+  // Then steal the oldest job of another queue
+  const std::size_t count = mQueues.size();
+  for (std::size_t i = 1; i < count; ++i) {
+    Queue &queue = *mQueues[(home + i) % count];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (!queue.jobs.empty()) {
+      std::shared_ptr<Job> job = std::move(queue.jobs.front());
+      queue.jobs.pop_front();
+      mQueued.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+bool JobSystem::helps(const Job &job, const Job &owner) {
+  for (const Job *ancestor = &job; ancestor;
+       ancestor = ancestor->parent.get()) {
+    if (ancestor == &owner)
+      return true;
+  }
+  for (const std::weak_ptr<Job> &dependency : owner.dependencies) {
+    std::shared_ptr<Job> locked = dependency.lock();
+    if (locked && helps(job, *locked))
+      return true;
+  }
+  return false;
+}
+
+std::shared_ptr<JobSystem::Job> JobSystem::findJobFor(const Job &owner) {
+  if (mQueued.load(std::memory_order_acquire) == 0)
+    return nullptr;
+
+  for (const std::unique_ptr<Queue> &queue : mQueues) {
+    std::lock_guard<std::mutex> lock(queue->mutex);
+    for (auto it = queue->jobs.begin(); it != queue->jobs.end(); ++it) {
+      if (!helps(**it, owner))
+        continue;
+      std::shared_ptr<Job> job = std::move(*it);
+      queue->jobs.erase(it);
+      mQueued.fetch_sub(1, std::memory_order_relaxed);
+      return job;
+    }
+  }
+  return nullptr;
+}
+
+void JobSystem::run(const std::shared_ptr<Job> &job) {
+  if (job->work)
+    job->work();
+  finish(job);
+}
+
+void JobSystem::finish(const std::shared_ptr<Job> &job) {
+  if (job->unfinished.fetch_sub(1, std::memory_order_acq_rel) != 1)
+    return; // Slices still running
+
+  std::vector<std::shared_ptr<Job>> continuations;
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->done = true;
+    continuations.swap(job->continuations);
+  }
+  for (const std::shared_ptr<Job> &next : continuations)
+    release(next);
+
+  if (job->parent)
+    finish(job->parent);
+}
+
+void JobSystem::release(const std::shared_ptr<Job> &job) {
+  if (job->blockers.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    push(job);
+}
+
+JobSystem::Handle
+JobSystem::submit(std::shared_ptr<Job> job,
+                  std::initializer_list<Handle> dependencies) {
+  for (const Handle &dependency : dependencies) {
+    if (!dependency.mJob)
+      continue;
+    std::lock_guard<std::mutex> lock(dependency.mJob->mutex);
+    if (dependency.mJob->done)
+      continue;
+    job->blockers.fetch_add(1, std::memory_order_relaxed);
+    job->dependencies.push_back(dependency.mJob);
+    dependency.mJob->continuations.push_back(job);
+  }
+
+  release(job); // Drop the scheduling blocker
+  return Handle(std::move(job));
+}
+
+JobSystem::Handle
+JobSystem::schedule(std::function<void()> work,
+                    std::initializer_list<Handle> dependencies) {
+  auto job = std::make_shared<Job>();
+  job->work = std::move(work);
+  return submit(std::move(job), dependencies);
+}
+
+JobSystem::Handle
+JobSystem::parallelFor(std::size_t count, std::size_t grain,
+                       std::function<void(std::size_t, std::size_t)> body,
+                       std::initializer_list<Handle> dependencies) {
+  grain = std::max<std::size_t>(grain, 1);
+  auto group = std::make_shared<Job>();
+
+  // The group's own work runs once the dependencies are met and fans the
+  // range out into slices; the group is done when they all are
+  auto shared =
+      std::make_shared<std::function<void(std::size_t, std::size_t)>>(
+          std::move(body));
+  std::weak_ptr<Job> weakGroup = group;
+  group->work = [this, count, grain, shared, weakGroup] {
+    std::shared_ptr<Job> self = weakGroup.lock();
+    for (std::size_t begin = 0; begin < count; begin += grain) {
+      std::size_t end = std::min(count, begin + grain);
+      auto slice = std::make_shared<Job>();
+      slice->work = [shared, begin, end] { (*shared)(begin, end); };
+      slice->parent = self;
+      self->unfinished.fetch_add(1, std::memory_order_relaxed);
+      push(std::move(slice));
+    }
+  };
+  return submit(std::move(group), dependencies);
+}
+
+void JobSystem::wait(const Handle &handle) {
+  while (!handle.isDone()) {
+    if (std::shared_ptr<Job> job = findJobFor(*handle.mJob))
+      run(job);
+    else
+      std::this_thread::yield();
+  }
+}
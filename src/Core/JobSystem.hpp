@@ -0,0 +1,131 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing thread pool for engine work (level parsing, mesh
+// building, entity batches).
+//
+// Every worker owns a queue: it pushes and pops its own jobs at the back
+// (newest first, still warm in cache) and, when empty, steals the oldest
+// job from the front of another queue. Threads outside the pool (main,
+// simulation, level loader) share one extra queue.
+//
+// wait() never just blocks: the waiting thread runs the queued parts of
+// the job it waits for (its slices and dependencies) until it is done, so
+// nested waits can't deadlock and a pool with zero workers still runs
+// everything (on the waiting thread). It doesn't take unrelated jobs, so
+// a tick waiting on its entity batches never picks up a long level load.
+class JobSystem {
+  struct Job;
+
+public:
+  // Refers to a scheduled job; cheap to copy. An empty handle counts as
+  // done.
+  class Handle {
+  public:
+    Handle() = default;
+    bool isDone() const;
+
+  private:
+    friend class JobSystem;
+    explicit Handle(std::shared_ptr<Job> job) : mJob(std::move(job)) {}
+    std::shared_ptr<Job> mJob;
+  };
+
+  // Negative workers picks one per hardware thread, minus the caller's.
+  // With zero, jobs run on whichever thread waits for them.
+  explicit JobSystem(int workers = -1);
+  ~JobSystem();
+
+  JobSystem(const JobSystem &) = delete;
+  JobSystem &operator=(const JobSystem &) = delete;
+
+  // Shared pool used by the engine. Its size can be set (e.g. from the
+  // command line) before the first call.
+  static JobSystem &instance();
+  static void setInstanceWorkers(int workers);
+
+  unsigned getWorkerCount() const {
+    return static_cast<unsigned>(mWorkers.size());
+  }
+
+  // Runs work once every dependency is done
+  Handle schedule(std::function<void()> work,
+                  std::initializer_list<Handle> dependencies = {});
+
+  // Calls body(begin, end) over [0, count) in slices of about grain
+  // indices, spread over the pool. The handle is done when every slice is.
+  Handle parallelFor(std::size_t count, std::size_t grain,
+                     std::function<void(std::size_t, std::size_t)> body,
+                     std::initializer_list<Handle> dependencies = {});
+
+  // Runs the handle's queued jobs on the calling thread until it is done
+  void wait(const Handle &handle);
+
+  // parallelFor() + wait(). Runs inline, without allocating, when there is
+  // only one slice or no workers.
+  template <typename Body>
+  void parallelForWait(std::size_t count, std::size_t grain, Body &&body) {
+    if (count == 0)
+      return;
+    if (count <= grain || mWorkers.empty()) {
+      body(std::size_t{0}, count);
+      return;
+    }
+    wait(parallelFor(count, grain, std::ref(body)));
+  }
+
+private:
+  struct Job {
+    std::function<void()> work;
+    std::shared_ptr<Job> parent; // parallelFor group this slice belongs to
+    std::vector<std::weak_ptr<Job>> dependencies; // Set before queueing
+
+    // 1 for the job itself plus one per unfinished slice
+    std::atomic<int> unfinished{1};
+    // 1 while scheduling plus one per unfinished dependency
+    std::atomic<int> blockers{1};
+
+    std::mutex mutex; // Guards done and continuations
+    bool done = false;
+    std::vector<std::shared_ptr<Job>> continuations;
+  };
+
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::shared_ptr<Job>> jobs;
+  };
+
+  void workerLoop(unsigned index);
+
+  // Queue of the calling thread (0 for threads outside the pool)
+  unsigned queueIndex() const;
+  void push(std::shared_ptr<Job> job);
+  std::shared_ptr<Job> findJob(unsigned home);
+  // Same, limited to jobs that help owner finish
+  std::shared_ptr<Job> findJobFor(const Job &owner);
+  static bool helps(const Job &job, const Job &owner);
+  void run(const std::shared_ptr<Job> &job);
+  void finish(const std::shared_ptr<Job> &job);
+  void release(const std::shared_ptr<Job> &job); // One blocker cleared
+
+  Handle submit(std::shared_ptr<Job> job,
+                std::initializer_list<Handle> dependencies);
+
+  std::vector<std::unique_ptr<Queue>> mQueues; // [0] = external threads
+  std::vector<std::thread> mWorkers;
+
+  // Sleeping workers are woken when jobs are pushed
+  std::mutex mWakeMutex;
+  std::condition_variable mWake;
+  std::atomic<std::size_t> mQueued{0};
+  bool mStopping = false;
+};
@@ -0,0 +1,118 @@
+#include "MappedFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &filename) {
+  close();
+
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return false;
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size)) {
+    CloseHandle(file);
+    return false;
+  }
+
+  mFile = file;
+  mSize = static_cast<size_t>(size.QuadPart);
+  mOpen = true;
+
+  // Empty files can't be mapped, but are still valid
+  if (mSize == 0)
+    return true;
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    close();
+    return false;
+  }
+  mMapping = mapping;
+
+  mData = static_cast<const char *>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!mData) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void MappedFile::close() {
+  if (mData)
+    UnmapViewOfFile(mData);
+  if (mMapping)
+    CloseHandle(static_cast<HANDLE>(mMapping));
+  if (mFile)
+    CloseHandle(static_cast<HANDLE>(mFile));
+
+  mData = nullptr;
+  mMapping = nullptr;
+  mFile = nullptr;
+  mSize = 0;
+  mOpen = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string &filename) {
+  close();
+
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    ::close(fd);
+    return false;
+  }
+
+  mFd = fd;
+  mSize = static_cast<size_t>(info.st_size);
+  mOpen = true;
+
+  // Empty files can't be mapped, but are still valid
+  if (mSize == 0)
+    return true;
+
+  void *data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (data == MAP_FAILED) {
+    close();
+    return false;
+  }
+
+  // Parsers read front to back
+  madvise(data, mSize, MADV_SEQUENTIAL);
+  mData = static_cast<const char *>(data);
+  return true;
+}
+
+void MappedFile::close() {
+  if (mData)
+    munmap(const_cast<char *>(mData), mSize);
+  if (mFd >= 0)
+    ::close(mFd);
+
+  mData = nullptr;
+  mFd = -1;
+  mSize = 0;
+  mOpen = false;
+}
+
+#endif
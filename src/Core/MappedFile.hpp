@@ -0,0 +1,35 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only memory mapping of a whole file.
+// The contents stay valid until close() or destruction, so parsers can work
+// on string_views into the mapping without copying.
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  bool open(const std::string &filename);
+  void close();
+
+  bool isOpen() const { return mOpen; }
+  std::string_view view() const { return {mData, mSize}; }
+  size_t size() const { return mSize; }
+
+private:
+  const char *mData = nullptr;
+  size_t mSize = 0;
+  bool mOpen = false;
+
+#ifdef _WIN32
+  void *mFile = nullptr;
+  void *mMapping = nullptr;
+#else
+  int mFd = -1;
+#endif
+};
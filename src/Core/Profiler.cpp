@@ -0,0 +1,212 @@
+#include "Profiler.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+
+namespace Profiler {
+
+namespace {
+
+const std::chrono::steady_clock::time_point gEpoch =
+    std::chrono::steady_clock::now();
+
+// Ring of recent zones for one thread. The owner appends and publishes
+// with head; readers only look at the newest half of the ring, since the
+// owner overwrites the other half next and won't reach these slots for
+// another CAPACITY / 2 zones. Slots are relaxed atomics so a reader
+// racing a very fast writer gets stale values rather than UB.
+struct ThreadBuffer {
+  static constexpr std::uint64_t CAPACITY = 1 << 14;
+
+  struct Slot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<std::int64_t> start{0};
+    std::atomic<std::int64_t> end{0};
+  };
+
+  std::array<Slot, CAPACITY> slots;
+  std::atomic<std::uint64_t> head{0};
+  std::uint32_t threadId = 0;
+};
+
+struct Event {
+  const char *name;
+  std::int64_t start;
+  std::int64_t end;
+  std::uint32_t threadId;
+};
+
+// Buffers are never freed, so zones from finished threads stay dumpable
+std::mutex gRegistryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> gBuffers;
+
+ThreadBuffer &localBuffer() {
+  thread_local ThreadBuffer *buffer = [] {
+    std::lock_guard<std::mutex> lock(gRegistryMutex);
+    gBuffers.push_back(std::make_unique<ThreadBuffer>());
+    gBuffers.back()->threadId = static_cast<std::uint32_t>(gBuffers.size());
+    return gBuffers.back().get();
+  }();
+  return *buffer;
+}
+
+// Frame boundaries (main thread only)
+constexpr size_t FRAME_HISTORY = 240;
+std::array<std::int64_t, FRAME_HISTORY + 1> gFrameEnds{};
+std::uint64_t gFrameCount = 0;
+
+std::int64_t frameEnd(std::uint64_t framesAgo) {
+  return gFrameEnds[(gFrameCount - 1 - framesAgo) % gFrameEnds.size()];
+}
+
+// Copies the readable zones of every thread. Returns the time from which
+// none are missing: a thread that recorded more than the readable half has
+// lost the zones that ended before its oldest readable one.
+std::int64_t snapshot(std::vector<Event> &out) {
+  std::lock_guard<std::mutex> lock(gRegistryMutex);
+  std::int64_t complete = 0;
+  for (const auto &buffer : gBuffers) {
+    std::uint64_t head = buffer->head.load(std::memory_order_acquire);
+    std::uint64_t available = std::min(head, ThreadBuffer::CAPACITY / 2);
+    if (available < head) {
+      const auto &oldest =
+          buffer->slots[(head - available) % ThreadBuffer::CAPACITY];
+      complete =
+          std::max(complete, oldest.end.load(std::memory_order_relaxed));
+    }
+    for (std::uint64_t i = head - available; i < head; ++i) {
+      const auto &slot = buffer->slots[i % ThreadBuffer::CAPACITY];
+      out.push_back({slot.name.load(std::memory_order_relaxed),
+                     slot.start.load(std::memory_order_relaxed),
+                     slot.end.load(std::memory_order_relaxed),
+                     buffer->threadId});
+    }
+  }
+  return complete;
+}
+
+} // namespace
+
+std::int64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - gEpoch)
+      .count();
+}
+
+void record(const char *name, std::int64_t start, std::int64_t end) {
+  ThreadBuffer &buffer = localBuffer();
+  std::uint64_t head = buffer.head.load(std::memory_order_relaxed);
+  auto &slot = buffer.slots[head % ThreadBuffer::CAPACITY];
+  slot.name.store(name, std::memory_order_relaxed);
+  slot.start.store(start, std::memory_order_relaxed);
+  slot.end.store(end, std::memory_order_relaxed);
+  buffer.head.store(head + 1, std::memory_order_release);
+}
+
+void endFrame() {
+  gFrameEnds[gFrameCount % gFrameEnds.size()] = now();
+  ++gFrameCount;
+}
+
+void getFrameTimes(std::vector<float> &out) {
+  out.clear();
+  if (gFrameCount < 2)
+    return;
+
+  std::uint64_t frames = std::min<std::uint64_t>(gFrameCount - 1,
+                                                 FRAME_HISTORY);
+  for (std::uint64_t ago = frames; ago > 0; --ago) {
+    out.push_back(static_cast<float>(frameEnd(ago - 1) - frameEnd(ago)) *
+                  1e-6f);
+  }
+}
+
+std::vector<ZoneStats> collectStats(int frames) {
+  std::vector<ZoneStats> stats;
+  if (gFrameCount < 2 || frames <= 0)
+    return stats;
+
+  std::uint64_t window =
+      std::min<std::uint64_t>({static_cast<std::uint64_t>(frames),
+                               gFrameCount - 1, FRAME_HISTORY});
+  std::vector<Event> events;
+  std::int64_t complete = snapshot(events);
+
+  // Only count the frames whose zones are all still buffered, or a busy
+  // thread's zones would show fewer calls per frame than it made
+  while (window > 1 && frameEnd(window) < complete)
+    --window;
+  std::int64_t windowStart = frameEnd(window);
+
+  // Group durations by zone name (the same literal can have different
+  // addresses in different translation units)
+  std::vector<std::pair<std::string_view, std::vector<double>>> zones;
+  for (const Event &event : events) {
+    if (!event.name || event.start < windowStart)
+      continue;
+    std::string_view name(event.name);
+    auto it = std::find_if(zones.begin(), zones.end(),
+                           [&](const auto &zone) { return zone.first == name; });
+    if (it == zones.end()) {
+      zones.push_back({name, {}});
+      it = zones.end() - 1;
+    }
+    it->second.push_back(static_cast<double>(event.end - event.start) * 1e-6);
+  }
+
+  for (auto &[name, durations] : zones) {
+    std::sort(durations.begin(), durations.end());
+    double total = 0.0;
+    for (double duration : durations)
+      total += duration;
+
+    ZoneStats zone;
+    zone.name = name;
+    zone.count = static_cast<std::uint32_t>(durations.size() / window);
+    zone.averageMs = total / durations.size();
+    zone.p99Ms = durations[(durations.size() - 1) * 99 / 100];
+    stats.push_back(std::move(zone));
+  }
+
+  std::sort(stats.begin(), stats.end(), [](const auto &a, const auto &b) {
+    return a.averageMs > b.averageMs;
+  });
+  return stats;
+}
+
+bool writeChromeTrace(const std::string &filename) {
+  std::vector<Event> events;
+  snapshot(events);
+
+  std::ofstream out(filename);
+  if (!out.is_open()) {
+    std::cerr << "Failed to write " << filename << std::endl;
+    return false;
+  }
+
+  // Complete ("X") events with microsecond timestamps
+  out << std::fixed << std::setprecision(3) << "{\"traceEvents\": [\n";
+  bool first = true;
+  for (const Event &event : events) {
+    if (!event.name)
+      continue;
+    out << (first ? "" : ",\n") << "  {\"name\": \"" << event.name
+        << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.threadId
+        << ", \"ts\": " << event.start / 1000.0
+        << ", \"dur\": " << (event.end - event.start) / 1000.0 << "}";
+    first = false;
+  }
+  out << "\n]}\n";
+
+  std::cout << "Wrote " << events.size() << " profiler zones to " << filename
+            << std::endl;
+  return true;
+}
+
+} // namespace Profiler
@@ -0,0 +1,71 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped CPU timers for finding stutter.
+// PROFILE_ZONE("name") times the rest of the enclosing scope. Each thread
+// records into its own ring buffer, which only that thread writes, so
+// recording never takes a lock. Configure with -DJTC_PROFILER=OFF to
+// compile every zone out.
+#ifdef JTC_PROFILER
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name)                                                     \
+  Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#endif
+
+namespace Profiler {
+
+#ifdef JTC_PROFILER
+constexpr bool ENABLED = true;
+#else
+constexpr bool ENABLED = false;
+#endif
+
+// Nanoseconds since the profiler started
+std::int64_t now();
+
+// Adds a finished zone to the calling thread's ring buffer.
+// name must outlive the profiler (zones use string literals).
+void record(const char *name, std::int64_t start, std::int64_t end);
+
+class Zone {
+public:
+  explicit Zone(const char *name) : mName(name), mStart(now()) {}
+  ~Zone() { record(mName, mStart, now()); }
+
+  Zone(const Zone &) = delete;
+  Zone &operator=(const Zone &) = delete;
+
+private:
+  const char *mName;
+  std::int64_t mStart;
+};
+
+// Marks the end of a rendered frame (main thread only)
+void endFrame();
+
+// Durations of the most recent frames in ms, oldest first
+void getFrameTimes(std::vector<float> &out);
+
+struct ZoneStats {
+  std::string name;
+  std::uint32_t count = 0; // Calls per frame, averaged
+  double averageMs = 0.0;  // Per call
+  double p99Ms = 0.0;      // Per call
+};
+
+// Per-zone timings over the last `frames` frames, slowest average first.
+// Fewer frames are used when a busy thread has already overwritten the
+// zones of the older ones.
+std::vector<ZoneStats> collectStats(int frames);
+
+// Writes every buffered zone as Chrome trace-event JSON
+// (open in chrome://tracing or ui.perfetto.dev)
+bool writeChromeTrace(const std::string &filename);
+
+} // namespace Profiler
@@ -0,0 +1,147 @@
+#include "Replay.hpp"
+#include "../Entities/EntityWorld.hpp"
+#include <algorithm>
+#include <bit>
+#include <iostream>
+
+namespace {
+constexpr char MAGIC[4] = {'J', 'T', 'C', 'R'};
+constexpr std::uint16_t VERSION = 1;
+constexpr std::uint16_t TICK_RATE = 60;
+
+// Input bits of a tick record
+constexpr std::uint8_t BIT_LEFT = 1 << 0;
+constexpr std::uint8_t BIT_RIGHT = 1 << 1;
+constexpr std::uint8_t BIT_JUMP = 1 << 2;
+constexpr std::uint8_t BIT_RESET = 1 << 3;
+
+template <typename T> void writeLE(std::ostream &out, T value) {
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    out.put(static_cast<char>((value >> (i * 8)) & 0xFF));
+  }
+}
+
+template <typename T> bool readLE(std::istream &in, T &value) {
+  value = 0;
+  for (size_t i = 0; i < sizeof(T); ++i) {
+    int byte = in.get();
+    if (byte == EOF)
+      return false;
+    value |= static_cast<T>(static_cast<std::uint8_t>(byte)) << (i * 8);
+  }
+  return true;
+}
+
+void hashBytes(std::uint64_t &hash, std::uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    hash ^= (value >> (i * 8)) & 0xFF;
+    hash *= 1099511628211ull; // FNV prime
+  }
+}
+} // namespace
+
+bool ReplayWriter::open(const std::string &filename,
+                        const std::string &levelPath) {
+  close();
+  mFile.open(filename, std::ios::binary | std::ios::trunc);
+  if (!mFile.is_open()) {
+    std::cerr << "Failed to create replay file: " << filename << std::endl;
+    return false;
+  }
+
+  mTickCount = 0;
+  mFile.write(MAGIC, sizeof(MAGIC));
+  writeLE(mFile, VERSION);
+  writeLE(mFile, TICK_RATE);
+  writeLE(mFile, mTickCount); // Patched in close()
+  writeLE(mFile, static_cast<std::uint16_t>(levelPath.size()));
+  mFile.write(levelPath.data(), levelPath.size());
+  return true;
+}
+
+void ReplayWriter::writeTick(const ReplayTick &tick) {
+  std::uint8_t bits = 0;
+  if (tick.input.left)
+    bits |= BIT_LEFT;
+  if (tick.input.right)
+    bits |= BIT_RIGHT;
+  if (tick.input.jump)
+    bits |= BIT_JUMP;
+  if (tick.reset)
+    bits |= BIT_RESET;
+
+  writeLE(mFile, bits);
+  writeLE(mFile, tick.stateHash);
+  ++mTickCount;
+}
+
+void ReplayWriter::close() {
+  if (!mFile.is_open())
+    return;
+
+  // Tick count lives right after magic, version and tick rate
+  mFile.seekp(sizeof(MAGIC) + 2 * sizeof(std::uint16_t));
+  writeLE(mFile, mTickCount);
+  mFile.close();
+}
+
+bool ReplayReader::open(const std::string &filename) {
+  mFile.open(filename, std::ios::binary);
+  if (!mFile.is_open()) {
+    std::cerr << "Failed to open replay file: " << filename << std::endl;
+    return false;
+  }
+
+  char magic[4] = {};
+  std::uint16_t version = 0;
+  std::uint16_t tickRate = 0;
+  std::uint16_t pathLength = 0;
+  mFile.read(magic, sizeof(magic));
+  if (!mFile || !std::equal(magic, magic + 4, MAGIC) ||
+      !readLE(mFile, version) || version != VERSION ||
+      !readLE(mFile, tickRate) || tickRate != TICK_RATE ||
+      !readLE(mFile, mTickCount) || !readLE(mFile, pathLength)) {
+    std::cerr << "Invalid replay file: " << filename << std::endl;
+    mFile.close();
+    return false;
+  }
+
+  mLevelPath.resize(pathLength);
+  mFile.read(mLevelPath.data(), pathLength);
+  mTicksRead = 0;
+  return static_cast<bool>(mFile);
+}
+
+bool ReplayReader::readTick(ReplayTick &tick) {
+  if (mTicksRead >= mTickCount)
+    return false;
+
+  std::uint8_t bits = 0;
+  if (!readLE(mFile, bits) || !readLE(mFile, tick.stateHash))
+    return false;
+
+  tick.input.left = bits & BIT_LEFT;
+  tick.input.right = bits & BIT_RIGHT;
+  tick.input.jump = bits & BIT_JUMP;
+  tick.reset = bits & BIT_RESET;
+  ++mTicksRead;
+  return true;
+}
+
+std::uint64_t hashPlayerState(const EntityWorld &world, EntityId player) {
+  std::uint64_t hash = 14695981039346656037ull; // FNV offset basis
+
+  sf::Vector2f position = world.getPosition(player);
+  sf::Vector2f velocity = world.getVelocity(player);
+  hashBytes(hash, std::bit_cast<std::uint32_t>(position.x));
+  hashBytes(hash, std::bit_cast<std::uint32_t>(position.y));
+  hashBytes(hash, std::bit_cast<std::uint32_t>(velocity.x));
+  hashBytes(hash, std::bit_cast<std::uint32_t>(velocity.y));
+
+  std::uint32_t flags =
+      (world.isOnGround(player) ? 1u : 0u) |
+      (world.isOnWall(player) ? 2u : 0u) |
+      static_cast<std::uint32_t>(world.getWallDir(player) + 1) << 2;
+  hashBytes(hash, flags);
+  return hash;
+}
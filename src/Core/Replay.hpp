@@ -0,0 +1,62 @@
+#pragma once
+#include "../Entities/PlayerInput.hpp"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+class EntityWorld;
+struct EntityId;
+
+// One recorded simulation tick
+struct ReplayTick {
+  PlayerInput input;
+  bool reset = false;          // R pressed before this tick
+  std::uint64_t stateHash = 0; // Player state after this tick
+};
+
+// Replay file layout (little-endian):
+//   "JTCR" | u16 version | u16 tick rate | u32 tick count |
+//   u16 level path length | level path bytes |
+//   per tick: u8 input bits | u64 state hash
+class ReplayWriter {
+public:
+  ~ReplayWriter() { close(); }
+
+  bool open(const std::string &filename, const std::string &levelPath);
+  void writeTick(const ReplayTick &tick);
+
+  // Patches the tick count into the header and closes the file
+  void close();
+
+  bool isOpen() const { return mFile.is_open(); }
+  std::uint32_t getTickCount() const { return mTickCount; }
+
+private:
+  std::ofstream mFile;
+  std::uint32_t mTickCount = 0;
+};
+
+class ReplayReader {
+public:
+  bool open(const std::string &filename);
+  void close() { mFile.close(); }
+
+  // Reads the next tick; returns false once all ticks have been read
+  bool readTick(ReplayTick &tick);
+
+  bool isOpen() const { return mFile.is_open(); }
+  const std::string &getLevelPath() const { return mLevelPath; }
+  std::uint32_t getTickCount() const { return mTickCount; }
+  std::uint32_t getTicksRead() const { return mTicksRead; }
+
+private:
+  std::ifstream mFile;
+  std::string mLevelPath;
+  std::uint32_t mTickCount = 0;
+  std::uint32_t mTicksRead = 0;
+};
+
+// FNV-1a hash of the player entity's position, velocity and grounded/wall
+// state.
+// Float members are hashed by bit pattern, so any drift is caught.
+std::uint64_t hashPlayerState(const EntityWorld &world, EntityId player);
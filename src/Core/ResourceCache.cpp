@@ -0,0 +1,24 @@
+#include "ResourceCache.hpp"
+
+namespace Resources {
+
+ResourceCache<sf::Texture> &textures() {
+  static ResourceCache<sf::Texture> cache;
+  return cache;
+}
+
+ResourceCache<sf::Font> &fonts() {
+  static ResourceCache<sf::Font> cache;
+  return cache;
+}
+
+void printStats(std::ostream &out) {
+  out << "Textures: " << textures().getLoadedCount() << " loaded, "
+      << textures().getHits() << " hits, " << textures().getMisses()
+      << " misses" << std::endl;
+  out << "Fonts: " << fonts().getLoadedCount() << " loaded, "
+      << fonts().getHits() << " hits, " << fonts().getMisses() << " misses"
+      << std::endl;
+}
+
+} // namespace Resources
@@ -0,0 +1,86 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// Path-keyed cache of loaded assets handing out shared handles.
+// Each file is decoded once and shared by every user; the cache only keeps
+// weak references, so an asset is released when its last handle goes away.
+template <typename Resource> class ResourceCache {
+public:
+  using Handle = std::shared_ptr<Resource>;
+
+  // Returns the cached asset or loads it; nullptr if loading failed
+  Handle get(const std::string &path) {
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    auto it = mEntries.find(path);
+    if (it != mEntries.end()) {
+      if (Handle handle = it->second.lock()) {
+        ++mHits;
+        return handle;
+      }
+    }
+
+    ++mMisses;
+    auto resource = std::make_shared<Resource>();
+    if (!load(*resource, path)) {
+      std::cerr << "Failed to load " << path << std::endl;
+      return nullptr;
+    }
+    mEntries[path] = resource;
+    return resource;
+  }
+
+  // Drops entries whose asset has already been released
+  void releaseUnused() {
+    std::lock_guard<std::mutex> lock(mMutex);
+    std::erase_if(mEntries,
+                  [](const auto &entry) { return entry.second.expired(); });
+  }
+
+  // Number of assets currently alive
+  size_t getLoadedCount() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t count = 0;
+    for (const auto &entry : mEntries)
+      count += entry.second.expired() ? 0 : 1;
+    return count;
+  }
+
+  size_t getHits() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mHits;
+  }
+  size_t getMisses() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mMisses;
+  }
+
+private:
+  static bool load(sf::Texture &texture, const std::string &path) {
+    return texture.loadFromFile(path);
+  }
+  static bool load(sf::Font &font, const std::string &path) {
+    return font.openFromFile(path);
+  }
+
+  mutable std::mutex mMutex;
+  std::unordered_map<std::string, std::weak_ptr<Resource>> mEntries;
+  size_t mHits = 0;
+  size_t mMisses = 0;
+};
+
+// Process-wide caches shared by the game, maps and entities
+namespace Resources {
+
+ResourceCache<sf::Texture> &textures();
+ResourceCache<sf::Font> &fonts();
+
+// Prints hit/miss counts and live assets for each cache
+void printStats(std::ostream &out);
+
+} // namespace Resources
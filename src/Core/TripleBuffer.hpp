@@ -0,0 +1,36 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer hand-off of the latest value.
+// The writer fills back() and publish()es it; the reader calls update() to
+// pick up the newest published value and reads front(). Neither side ever
+// waits, and the reader skips values it was too slow to see.
+template <typename T> class TripleBuffer {
+public:
+  // Writer side
+  T &back() { return mSlots[mBack]; }
+  void publish() {
+    mBack = mMiddle.exchange(mBack | FRESH, std::memory_order_acq_rel) & INDEX;
+  }
+
+  // Reader side: true if a newer value became front()
+  bool update() {
+    if (!(mMiddle.load(std::memory_order_relaxed) & FRESH))
+      return false;
+    mFront = mMiddle.exchange(mFront, std::memory_order_acq_rel) & INDEX;
+    return true;
+  }
+  const T &front() const { return mSlots[mFront]; }
+
+private:
+  // Slot index in the low bits, plus a flag for "published, not yet read"
+  static constexpr std::uint8_t INDEX = 3;
+  static constexpr std::uint8_t FRESH = 4;
+
+  std::array<T, 3> mSlots{};
+  std::uint8_t mBack = 0;                  // Writer only
+  alignas(64) std::atomic<std::uint8_t> mMiddle{1};
+  alignas(64) std::uint8_t mFront = 2;     // Reader only
+};
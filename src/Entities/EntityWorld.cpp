@@ -0,0 +1,694 @@
+#include "EntityWorld.hpp"
+#include "../Core/JobSystem.hpp"
+#include "../Core/Profiler.hpp"
+#include "../Graphics/TextureAtlas.hpp"
+#include "../World/Map.hpp"
+
+#include <array>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+const std::array<MovementParams, ENTITY_KIND_COUNT> &paramsTable() {
+  static const std::array<MovementParams, ENTITY_KIND_COUNT> table = [] {
+    std::array<MovementParams, ENTITY_KIND_COUNT> params;
+
+    MovementParams &player = params[static_cast<int>(EntityKind::Player)];
+    player.size = {24.f, 32.f}; // Hitbox at feet
+    player.moveSpeed = 300.f;
+    player.acceleration = 1500.f;
+    player.friction = 1200.f;
+    player.gravity = 1000.f;
+    player.jumpStrength = 500.f;
+    player.wallSlideSpeed = 80.f;
+    player.wallJumpForce = {320.f, 480.f};
+
+    // Walks at a constant speed, turning at walls and ledges
+    MovementParams &enemy = params[static_cast<int>(EntityKind::Enemy)];
+    enemy.size = {24.f, 32.f};
+    enemy.moveSpeed = 60.f;
+    enemy.gravity = 1000.f;
+
+    // Flies straight until it hits a wall
+    MovementParams &projectile =
+        params[static_cast<int>(EntityKind::Projectile)];
+    projectile.size = {8.f, 8.f};
+
+    // Drops to the floor and stays there
+    MovementParams &pickup = params[static_cast<int>(EntityKind::Pickup)];
+    pickup.size = {16.f, 16.f};
+    pickup.friction = 600.f;
+    pickup.gravity = 1000.f;
+    return params;
+  }();
+  return table;
+}
+
+// Tint per kind; enemies reuse the player frames
+const sf::Color KIND_COLORS[ENTITY_KIND_COUNT] = {
+    sf::Color::White, sf::Color(255, 110, 110), sf::Color(255, 220, 80),
+    sf::Color(90, 220, 255)};
+
+// Player and enemy sprites: 32x32 frames, scaled and anchored at the
+// bottom-center of the hitbox
+constexpr float FRAME_SIZE = 32.f;
+const sf::Vector2f CHARACTER_SCALE{1.3f, 1.5f};
+
+void appendQuad(sf::VertexArray &out, sf::Vector2f topLeft, sf::Vector2f size,
+                sf::FloatRect uv, sf::Color color) {
+  float left = topLeft.x;
+  float top = topLeft.y;
+  float right = left + size.x;
+  float bottom = top + size.y;
+
+  float u0 = uv.position.x;
+  float v0 = uv.position.y;
+  float u1 = u0 + uv.size.x; // Negative width mirrors the sprite
+  float v1 = v0 + uv.size.y;
+
+  out.append({{left, top}, color, {u0, v0}});
+  out.append({{right, top}, color, {u1, v0}});
+  out.append({{left, bottom}, color, {u0, v1}});
+  out.append({{left, bottom}, color, {u0, v1}});
+  out.append({{right, top}, color, {u1, v0}});
+  out.append({{right, bottom}, color, {u1, v1}});
+}
+
+} // namespace
+
+EntityWorld::EntityWorld(std::size_t capacity) : mCapacity(capacity) {
+  mKind.reserve(capacity);
+  mPosX.reserve(capacity);
+  mPosY.reserve(capacity);
+  mPrevX.reserve(capacity);
+  mPrevY.reserve(capacity);
+  mVelX.reserve(capacity);
+  mVelY.reserve(capacity);
+  mFlags.reserve(capacity);
+  mWallDir.reserve(capacity);
+  mInput.reserve(capacity);
+  mFrame.reserve(capacity);
+  mAnimTimer.reserve(capacity);
+  mSlot.reserve(capacity);
+
+  mSlotIndex.reserve(capacity);
+  mSlotGeneration.reserve(capacity);
+  mFreeSlots.reserve(capacity);
+}
+
+const MovementParams &EntityWorld::getParams(EntityKind kind) {
+  return paramsTable()[static_cast<int>(kind)];
+}
+
+EntityId EntityWorld::spawn(EntityKind kind, sf::Vector2f center,
+                            sf::Vector2f velocity) {
+  if (mKind.size() >= mCapacity)
+    return {};
+
+  std::uint32_t slot;
+  if (!mFreeSlots.empty()) {
+    slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+  } else {
+    slot = static_cast<std::uint32_t>(mSlotIndex.size());
+    mSlotIndex.push_back(0);
+    mSlotGeneration.push_back(0);
+  }
+  mSlotIndex[slot] = static_cast<std::uint32_t>(mKind.size());
+
+  sf::Vector2f size = getParams(kind).size;
+  float x = center.x - size.x / 2.f;
+  float y = center.y - size.y / 2.f;
+
+  mKind.push_back(kind);
+  mPosX.push_back(x);
+  mPosY.push_back(y);
+  mPrevX.push_back(x);
+  mPrevY.push_back(y);
+  mVelX.push_back(velocity.x);
+  mVelY.push_back(velocity.y);
+  mFlags.push_back(velocity.x < 0.f ? 0 : FACING_RIGHT);
+  mWallDir.push_back(0);
+  mInput.push_back(0);
+  mFrame.push_back(0);
+  mAnimTimer.push_back(0.f);
+  mSlot.push_back(slot);
+
+  return {slot, mSlotGeneration[slot]};
+}
+
+bool EntityWorld::isAlive(EntityId id) const {
+  return id.slot < mSlotGeneration.size() &&
+         mSlotGeneration[id.slot] == id.generation &&
+         !(mFlags[indexOf(id)] & DEAD);
+}
+
+void EntityWorld::destroy(EntityId id) {
+  if (isAlive(id))
+    kill(indexOf(id));
+}
+
+void EntityWorld::clearExcept(EntityId keep) {
+  for (std::size_t i = 0; i < mKind.size(); ++i) {
+    if (mSlot[i] != keep.slot)
+      kill(i);
+  }
+  removeDead();
+  mBroadphase.clear();
+  mBroadphase.build();
+}
+
+void EntityWorld::reset(EntityId id, sf::Vector2f center) {
+  std::size_t i = indexOf(id);
+  sf::Vector2f size = getParams(mKind[i]).size;
+  mPosX[i] = center.x - size.x / 2.f;
+  mPosY[i] = center.y - size.y / 2.f;
+  mPrevX[i] = mPosX[i]; // Teleport, don't interpolate
+  mPrevY[i] = mPosY[i];
+  mVelX[i] = 0.f;
+  mVelY[i] = 0.f;
+  mFlags[i] &= ~GROUNDED;
+}
+
+void EntityWorld::setInput(EntityId id, const PlayerInput &input) {
+  mInput[indexOf(id)] = (input.left ? INPUT_LEFT : 0) |
+                        (input.right ? INPUT_RIGHT : 0) |
+                        (input.jump ? INPUT_JUMP : 0);
+}
+
+sf::Vector2f EntityWorld::getPosition(EntityId id) const {
+  std::size_t i = indexOf(id);
+  return {mPosX[i], mPosY[i]};
+}
+
+sf::Vector2f EntityWorld::getVelocity(EntityId id) const {
+  std::size_t i = indexOf(id);
+  return {mVelX[i], mVelY[i]};
+}
+
+sf::FloatRect EntityWorld::getBounds(EntityId id) const {
+  std::size_t i = indexOf(id);
+  return {{mPosX[i], mPosY[i]}, getParams(mKind[i]).size};
+}
+
+bool EntityWorld::isOnGround(EntityId id) const {
+  return mFlags[indexOf(id)] & GROUNDED;
+}
+
+bool EntityWorld::isOnWall(EntityId id) const {
+  return mFlags[indexOf(id)] & WALL_SLIDING;
+}
+
+int EntityWorld::getWallDir(EntityId id) const {
+  return mWallDir[indexOf(id)];
+}
+
+void EntityWorld::update(float dt, const Map &map) {
+  PROFILE_ZONE("EntityWorld::update");
+  controlSystem(dt, map);
+  physicsSystem(dt, map);
+  contactSystem();
+  animationSystem(dt);
+  removeDead();
+}
+
+void EntityWorld::controlSystem(float dt, const Map &map) {
+  PROFILE_ZONE("EntityWorld::control");
+  JobSystem::instance().parallelForWait(
+      mKind.size(), BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+        controlBatch(begin, end, dt, map);
+      });
+}
+
+void EntityWorld::controlBatch(std::size_t begin, std::size_t end, float dt,
+                               const Map &map) {
+  for (std::size_t i = begin; i < end; ++i) {
+    const MovementParams &params = getParams(mKind[i]);
+    float velocityX = mVelX[i];
+    float velocityY = mVelY[i];
+    std::uint8_t flags = mFlags[i];
+
+    switch (mKind[i]) {
+    case EntityKind::Player: {
+      // 1. Input Handling & Dynamic Speed (Acceleration/Friction)
+      bool left = mInput[i] & INPUT_LEFT;
+      bool right = mInput[i] & INPUT_RIGHT;
+      bool jumpPressed = mInput[i] & INPUT_JUMP;
+      bool grounded = flags & GROUNDED;
+
+      // Horizontal Movement with Acceleration
+      if (left && !right) {
+        velocityX -= params.acceleration * dt;
+      } else if (right && !left) {
+        velocityX += params.acceleration * dt;
+      } else {
+        // Friction
+        if (velocityX > 0) {
+          velocityX -= params.friction * dt;
+          if (velocityX < 0)
+            velocityX = 0;
+        } else if (velocityX < 0) {
+          velocityX += params.friction * dt;
+          if (velocityX > 0)
+            velocityX = 0;
+        }
+      }
+
+      // Cap speed
+      if (velocityX > params.moveSpeed)
+        velocityX = params.moveSpeed;
+      if (velocityX < -params.moveSpeed)
+        velocityX = -params.moveSpeed;
+
+      // 2. Wall Detection Logic (is there a wall within 2px to either side)
+      sf::FloatRect bounds({mPosX[i], mPosY[i]}, params.size);
+      bool touchingLeft = map.sweepAABB(bounds, {-2.f, 0.f}).hit;
+      bool touchingRight = map.sweepAABB(bounds, {2.f, 0.f}).hit;
+
+      // Reset wall state
+      bool wallSliding = false;
+      int wallDir = 0;
+
+      if (touchingLeft)
+        wallDir = -1;
+      if (touchingRight)
+        wallDir = 1;
+
+      // Wall Slide
+      if (wallDir != 0 && velocityY > 0 && !grounded) {
+        if ((wallDir == -1 && left) || (wallDir == 1 && right)) {
+          wallSliding = true;
+          velocityY = params.wallSlideSpeed;
+        }
+      }
+
+      // 3. Jump and Wall Jump
+      // Only trigger on rising edge (first frame of press)
+      bool jumpJustPressed = jumpPressed && !(flags & JUMP_HELD);
+
+      if (jumpJustPressed) {
+        // Normal Jump
+        if (grounded) {
+          velocityY = -params.jumpStrength;
+          grounded = false;
+        }
+        // Wall Jump
+        else if (wallSliding || (wallDir != 0 && !grounded)) {
+          velocityY = -params.wallJumpForce.y;
+          velocityX = -wallDir * params.wallJumpForce.x;
+        }
+      }
+
+      // 4. Variable Gravity (Dynamic Acceleration) with Gravity Halt at Peak
+      float currentGravity = params.gravity;
+
+      // Gravity Halt: near the peak of the jump (velocity close to 0),
+      // reduce gravity
+      const float peakThreshold = 50.f; // velocity range considered "peak"
+      if (std::abs(velocityY) < peakThreshold && !grounded && !wallSliding) {
+        currentGravity *= 0.7f; // Reduced gravity at peak for floaty feel
+      }
+      // Variable gravity relies on holding the button
+      else if (velocityY < 0.f && !jumpPressed) {
+        // Rising but button released: heavier gravity (shorter jump)
+        currentGravity *= 2.0f;
+      } else if (velocityY > 0.f) {
+        // Falling: heavier gravity (fast fall), unless sliding
+        if (!wallSliding) {
+          currentGravity *= 1.8f;
+        } else {
+          currentGravity = 0; // Handled by slide constant speed
+        }
+      }
+
+      velocityY += currentGravity * dt;
+
+      flags &= ~(GROUNDED | WALL_SLIDING | JUMP_HELD);
+      flags |= (grounded ? GROUNDED : 0) | (wallSliding ? WALL_SLIDING : 0) |
+               (jumpPressed ? JUMP_HELD : 0);
+      mWallDir[i] = static_cast<std::int8_t>(wallDir);
+      break;
+    }
+
+    case EntityKind::Enemy: {
+      // Turn around before walking off a ledge
+      if (flags & GROUNDED) {
+        float aheadX = (flags & FACING_RIGHT) ? mPosX[i] + params.size.x + 1.f
+                                              : mPosX[i] - 1.f;
+        float belowY = mPosY[i] + params.size.y + 1.f;
+        int aheadTile = static_cast<int>(std::floor(aheadX / Map::TILE_SIZE));
+        int belowTile = static_cast<int>(std::floor(belowY / Map::TILE_SIZE));
+        if (!map.isGround(aheadTile, belowTile))
+          flags ^= FACING_RIGHT;
+      }
+      velocityX = (flags & FACING_RIGHT) ? params.moveSpeed : -params.moveSpeed;
+      velocityY += params.gravity * dt;
+      break;
+    }
+
+    case EntityKind::Projectile:
+      break;
+
+    case EntityKind::Pickup:
+      if (flags & GROUNDED) {
+        float slowdown = params.friction * dt;
+        velocityX = std::abs(velocityX) <= slowdown
+                        ? 0.f
+                        : velocityX - std::copysign(slowdown, velocityX);
+      }
+      velocityY += params.gravity * dt;
+      break;
+    }
+
+    mVelX[i] = velocityX;
+    mVelY[i] = velocityY;
+    mFlags[i] = flags;
+  }
+}
+
+void EntityWorld::physicsSystem(float dt, const Map &map) {
+  PROFILE_ZONE("EntityWorld::physics");
+  JobSystem::instance().parallelForWait(
+      mKind.size(), BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+        physicsBatch(begin, end, dt, map);
+      });
+}
+
+void EntityWorld::physicsBatch(std::size_t begin, std::size_t end, float dt,
+                               const Map &map) {
+  const float fallLimit = map.getHeight() + 4.f * Map::TILE_SIZE;
+
+  // Each axis is swept through the map separately, so an entity stops
+  // exactly at the first wall in the way, however fast it moves
+  for (std::size_t i = begin; i < end; ++i) {
+    const EntityKind kind = mKind[i];
+    sf::FloatRect bounds({mPosX[i], mPosY[i]}, getParams(kind).size);
+    mPrevX[i] = bounds.position.x;
+    mPrevY[i] = bounds.position.y;
+
+    // --- X-AXIS ---
+    Map::SweepHit hitX = map.sweepAABB(bounds, {mVelX[i] * dt, 0.f});
+    bounds.position = hitX.position;
+    if (hitX.hit) {
+      if (kind == EntityKind::Projectile)
+        kill(i);
+      else if (kind == EntityKind::Enemy)
+        mFlags[i] ^= FACING_RIGHT; // Turn around
+      mVelX[i] = 0; // Stop on wall
+    }
+
+    // --- Y-AXIS ---
+    // Reset grounded (will be set true if we land on something)
+    mFlags[i] &= ~GROUNDED;
+
+    sf::Vector2f moveY(0.f, mVelY[i] * dt);
+    Map::SweepHit hitY = map.sweepAABB(bounds, moveY);
+    bounds.position = hitY.position;
+
+    if (hitY.hit && kind == EntityKind::Projectile) {
+      kill(i);
+    } else if (hitY.hit && hitY.normal.y < 0.f) { // Landed
+      mVelY[i] = 0.f;
+      mFlags[i] |= GROUNDED;
+    } else if (hitY.hit) { // Head hit a ceiling
+      bool nudged = false;
+
+      if (kind == EntityKind::Player) {
+        // Upwards Corner Correction: if a small sideways nudge clears the
+        // corner, slip past it and keep the rest of the jump
+        const float cornerMargin = 6.f; // Pixels to check for nudge
+        sf::Vector2f remaining = moveY * (1.f - hitY.time);
+        sf::FloatRect probe = bounds;
+
+        for (float nudge : {-cornerMargin, cornerMargin}) {
+          probe.position = hitY.position;
+          Map::SweepHit side = map.sweepAABB(probe, {nudge, 0.f});
+          if (side.hit)
+            continue;
+          probe.position = side.position;
+          Map::SweepHit up = map.sweepAABB(probe, remaining);
+          if (up.hit)
+            continue;
+          bounds.position = up.position;
+          nudged = true;
+          break;
+        }
+      }
+
+      // Can't nudge, stop upward movement
+      if (!nudged)
+        mVelY[i] = 0.f;
+    }
+
+    mPosX[i] = bounds.position.x;
+    mPosY[i] = bounds.position.y;
+
+    // Anything but the player is gone once it falls out of the level (the
+    // game respawns the player itself)
+    if (kind != EntityKind::Player && bounds.position.y > fallLimit)
+      kill(i);
+  }
+}
+
+void EntityWorld::contactSystem() {
+  PROFILE_ZONE("EntityWorld::contacts");
+  const std::size_t count = mKind.size();
+
+  mBroadphase.clear();
+  for (std::size_t i = 0; i < count; ++i) {
+    if (mFlags[i] & DEAD)
+      continue;
+    mBroadphase.insert(mSlot[i], {{mPosX[i], mPosY[i]},
+                                  getParams(mKind[i]).size});
+  }
+  mBroadphase.build();
+
+  // Projectiles take out enemies, the player collects pickups. Piled up
+  // entities overlap each other a lot, so rather than enumerating every
+  // pair, only the few entities that act on others look around them.
+  for (std::size_t i = 0; i < count; ++i) {
+    const EntityKind kind = mKind[i];
+    if ((kind != EntityKind::Projectile && kind != EntityKind::Player) ||
+        (mFlags[i] & DEAD))
+      continue;
+
+    const EntityKind target =
+        kind == EntityKind::Projectile ? EntityKind::Enemy : EntityKind::Pickup;
+    sf::FloatRect bounds({mPosX[i], mPosY[i]}, getParams(kind).size);
+    mBroadphase.query(bounds, [&](std::uint32_t slot) {
+      std::size_t other = mSlotIndex[slot];
+      if (mKind[other] != target || (mFlags[other] & DEAD))
+        return true;
+      kill(other);
+      if (kind == EntityKind::Projectile) {
+        kill(i); // Spent on the first enemy
+        return false;
+      }
+      return true;
+    });
+  }
+}
+
+EntityWorld::RayHit EntityWorld::raycast(sf::Vector2f origin,
+                                         sf::Vector2f direction,
+                                         float maxDistance,
+                                         EntityId ignore) const {
+  SpatialHash::RayHit hit = mBroadphase.raycast(
+      origin, direction, maxDistance, [&](std::uint32_t slot) {
+        EntityId id{slot, mSlotGeneration[slot]};
+        return !(id == ignore) && isAlive(id);
+      });
+
+  RayHit result;
+  if (hit.hit) {
+    result.hit = true;
+    result.entity = {hit.id, mSlotGeneration[hit.id]};
+    result.distance = hit.distance;
+    result.normal = hit.normal;
+  }
+  return result;
+}
+
+void EntityWorld::animationSystem(float dt) {
+  PROFILE_ZONE("EntityWorld::animation");
+  const std::size_t count = mKind.size();
+
+  for (std::size_t i = 0; i < count; ++i) {
+    EntityKind kind = mKind[i];
+    if (kind != EntityKind::Player && kind != EntityKind::Enemy)
+      continue;
+
+    // Idle Animation Update (only when grounded and not moving)
+    if ((mFlags[i] & GROUNDED) && std::abs(mVelX[i]) < 10.f) {
+      mAnimTimer[i] += dt;
+
+      // Different timing for each frame transition (0→1: 2s, 1→0: 0.5s)
+      float frameDelay = (mFrame[i] == 0) ? 2.0f : 0.5f;
+
+      if (mAnimTimer[i] >= frameDelay) {
+        mAnimTimer[i] = 0.f;
+        mFrame[i] = (mFrame[i] + 1) % 2; // 2 frames
+      }
+    } else {
+      // Reset to first frame when moving/in air
+      mFrame[i] = 0;
+      mAnimTimer[i] = 0.f;
+    }
+
+    // Flip Logic (enemies flip when they turn, even while stopped by a
+    // wall)
+    if (mVelX[i] > 1.f) {
+      mFlags[i] |= FACING_RIGHT;
+    } else if (mVelX[i] < -1.f) {
+      mFlags[i] &= ~FACING_RIGHT;
+    }
+  }
+}
+
+void EntityWorld::kill(std::size_t index) {
+  if (mFlags[index] & DEAD)
+    return;
+  mFlags[index] |= DEAD;
+  mDeadCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void EntityWorld::removeDead() {
+  if (mDeadCount.load(std::memory_order_relaxed) == 0)
+    return;
+
+  std::size_t i = 0;
+  while (i < mKind.size()) {
+    if (!(mFlags[i] & DEAD)) {
+      ++i;
+      continue;
+    }
+
+    // Retire the slot so old handles stop resolving
+    std::uint32_t slot = mSlot[i];
+    ++mSlotGeneration[slot];
+    mFreeSlots.push_back(slot);
+
+    // Move the last entity into the hole
+    std::size_t last = mKind.size() - 1;
+    if (i != last) {
+      mKind[i] = mKind[last];
+      mPosX[i] = mPosX[last];
+      mPosY[i] = mPosY[last];
+      mPrevX[i] = mPrevX[last];
+      mPrevY[i] = mPrevY[last];
+      mVelX[i] = mVelX[last];
+      mVelY[i] = mVelY[last];
+      mFlags[i] = mFlags[last];
+      mWallDir[i] = mWallDir[last];
+      mInput[i] = mInput[last];
+      mFrame[i] = mFrame[last];
+      mAnimTimer[i] = mAnimTimer[last];
+      mSlot[i] = mSlot[last];
+      mSlotIndex[mSlot[i]] = static_cast<std::uint32_t>(i);
+    }
+
+    mKind.pop_back();
+    mPosX.pop_back();
+    mPosY.pop_back();
+    mPrevX.pop_back();
+    mPrevY.pop_back();
+    mVelX.pop_back();
+    mVelY.pop_back();
+    mFlags.pop_back();
+    mWallDir.pop_back();
+    mInput.pop_back();
+    mFrame.pop_back();
+    mAnimTimer.pop_back();
+    mSlot.pop_back();
+  }
+  mDeadCount.store(0, std::memory_order_relaxed);
+}
+
+void EntityWorld::loadResources(const TextureAtlas &atlas) {
+  // Idle frames (idle.png is 64x32, 2 frames of 32x32)
+  const TextureAtlas::Region *player = atlas.find("player_idle");
+  // Plain white texels, tinted per kind
+  const TextureAtlas::Region *white = atlas.find("white");
+  if (!player || !white) {
+    std::cerr << "Failed to load entity sprites!" << std::endl;
+    return;
+  }
+
+  mTexture = player->texture;
+  sf::IntRect frame(player->rect.position, {32, 32});
+  mFrames[static_cast<int>(EntityKind::Player)] = frame;
+  mFrames[static_cast<int>(EntityKind::Enemy)] = frame;
+
+  // Sample the middle of the region so filtering never reaches its edge
+  sf::IntRect solid(white->rect.position + white->rect.size / 2, {0, 0});
+  mFrames[static_cast<int>(EntityKind::Projectile)] = solid;
+  mFrames[static_cast<int>(EntityKind::Pickup)] = solid;
+}
+
+void EntityWorld::copySprites(SpriteList &out) const {
+  const std::size_t count = mKind.size();
+  out.kind.assign(mKind.begin(), mKind.end());
+  out.previousPosition.resize(count);
+  out.position.resize(count);
+  out.frame.assign(mFrame.begin(), mFrame.end());
+  out.facingRight.resize(count);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    out.previousPosition[i] = {mPrevX[i], mPrevY[i]};
+    out.position[i] = {mPosX[i], mPosY[i]};
+    out.facingRight[i] = (mFlags[i] & FACING_RIGHT) ? 1 : 0;
+  }
+}
+
+void EntityWorld::buildSprites(const SpriteList &sprites, float alpha,
+                               sf::VertexArray &out) const {
+  PROFILE_ZONE("EntityWorld::buildSprites");
+  const std::size_t count = sprites.size();
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const int kind = static_cast<int>(sprites.kind[i]);
+    const sf::Vector2f size = paramsTable()[kind].size;
+    const sf::Vector2f position =
+        sprites.previousPosition[i] +
+        (sprites.position[i] - sprites.previousPosition[i]) * alpha;
+    const sf::IntRect &frame = mFrames[kind];
+
+    if (sprites.kind[i] == EntityKind::Player ||
+        sprites.kind[i] == EntityKind::Enemy) {
+      // Bottom-center of the sprite on the bottom-center of the hitbox
+      sf::Vector2f drawSize(FRAME_SIZE * CHARACTER_SCALE.x,
+                            FRAME_SIZE * CHARACTER_SCALE.y);
+      sf::Vector2f topLeft(position.x + size.x / 2.f - drawSize.x / 2.f,
+                           position.y + size.y - drawSize.y);
+
+      sf::FloatRect uv(
+          {static_cast<float>(frame.position.x) + sprites.frame[i] * FRAME_SIZE,
+           static_cast<float>(frame.position.y)},
+          {FRAME_SIZE, FRAME_SIZE});
+      if (!sprites.facingRight[i]) {
+        uv.position.x += uv.size.x;
+        uv.size.x = -uv.size.x;
+      }
+      appendQuad(out, topLeft, drawSize, uv, KIND_COLORS[kind]);
+    } else {
+      sf::FloatRect uv(sf::Vector2f(frame.position), {0.f, 0.f});
+      appendQuad(out, position, size, uv, KIND_COLORS[kind]);
+    }
+  }
+}
+
+void EntityWorld::buildHitboxes(const SpriteList &sprites, float alpha,
+                                sf::VertexArray &out) const {
+  const std::size_t count = sprites.size();
+  const sf::Color color(255, 0, 0, 100);
+
+  for (std::size_t i = 0; i < count; ++i) {
+    const sf::Vector2f size =
+        paramsTable()[static_cast<int>(sprites.kind[i])].size;
+    const sf::Vector2f position =
+        sprites.previousPosition[i] +
+        (sprites.position[i] - sprites.previousPosition[i]) * alpha;
+    appendQuad(out, position, size, {}, color);
+  }
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include "../World/SpatialHash.hpp"
+#include "PlayerInput.hpp"
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class Map;
+class TextureAtlas;
+
+enum class EntityKind : std::uint8_t { Player, Enemy, Projectile, Pickup };
+constexpr int ENTITY_KIND_COUNT = 4;
+
+// Handle to an entity. The generation changes whenever a slot is reused, so
+// a handle to a destroyed entity never aliases a newer one.
+struct EntityId {
+  static constexpr std::uint32_t INVALID = 0xFFFFFFFFu;
+
+  std::uint32_t slot = INVALID;
+  std::uint32_t generation = 0;
+
+  bool isValid() const { return slot != INVALID; }
+  bool operator==(const EntityId &) const = default;
+};
+
+// Movement tuning shared by every entity of a kind
+struct MovementParams {
+  sf::Vector2f size; // Hitbox
+  float moveSpeed = 0.f;
+  float acceleration = 0.f;
+  float friction = 0.f;
+  float gravity = 0.f;
+  float jumpStrength = 0.f;
+  float wallSlideSpeed = 0.f;
+  sf::Vector2f wallJumpForce;
+};
+
+// What drawing needs from one tick, copied out column by column so the
+// simulation can keep running while a frame is built from it. Reused
+// between ticks; copying into it allocates only when the world grows.
+struct SpriteList {
+  std::vector<EntityKind> kind;
+  std::vector<sf::Vector2f> previousPosition; // Hitbox top-left before tick
+  std::vector<sf::Vector2f> position;         // Hitbox top-left after tick
+  std::vector<std::uint8_t> frame;
+  std::vector<std::uint8_t> facingRight;
+
+  std::size_t size() const { return kind.size(); }
+};
+
+// All dynamic objects of a level (the player, enemies, projectiles,
+// pickups) in structure-of-arrays form: one dense column per component,
+// indexed by the same position. Systems walk the columns front to back,
+// and destroying an entity moves the last one into its place, so the
+// columns never have holes. Storage is reserved up front; nothing is
+// allocated per entity.
+class EntityWorld {
+public:
+  explicit EntityWorld(std::size_t capacity = 16384);
+
+  // Adds an entity with its hitbox centered on center. Returns an invalid
+  // id when the world is full.
+  EntityId spawn(EntityKind kind, sf::Vector2f center,
+                 sf::Vector2f velocity = {});
+
+  // Removes the entity at the end of the current (or next) update
+  void destroy(EntityId id);
+  bool isAlive(EntityId id) const;
+
+  // Removes everything except the given entity
+  void clearExcept(EntityId keep);
+
+  std::size_t size() const { return mKind.size(); }
+  std::size_t capacity() const { return mCapacity; }
+
+  // Centers the hitbox on center and stops the entity (respawn)
+  void reset(EntityId id, sf::Vector2f center);
+
+  // Controls used by the next update (player entities only)
+  void setInput(EntityId id, const PlayerInput &input);
+
+  // One fixed tick: control (player input, enemy patrol), physics against
+  // the map, entity contacts, animation, then removal of destroyed
+  // entities
+  void update(float dt, const Map &map);
+
+  // Calls visit(EntityId) for each live entity overlapping the bounds, at
+  // the positions of the last update (later spawns aren't included)
+  template <typename Visitor>
+  void queryBounds(const sf::FloatRect &bounds, Visitor &&visit) const;
+
+  struct RayHit {
+    bool hit = false;
+    EntityId entity;
+    float distance = 0.f;
+    sf::Vector2f normal;
+  };
+
+  // Nearest live entity along a ray (see SpatialHash::raycast), skipping
+  // ignore (e.g. the shooter)
+  RayHit raycast(sf::Vector2f origin, sf::Vector2f direction,
+                 float maxDistance, EntityId ignore = {}) const;
+
+  sf::Vector2f getPosition(EntityId id) const; // Hitbox top-left
+  sf::Vector2f getVelocity(EntityId id) const;
+  sf::FloatRect getBounds(EntityId id) const;
+  bool isOnGround(EntityId id) const;
+  bool isOnWall(EntityId id) const;
+  int getWallDir(EntityId id) const;
+
+  static const MovementParams &getParams(EntityKind kind);
+
+  // Finds each kind's frames in the atlas (not needed for headless
+  // simulation). Read-only afterwards, so any thread may build sprites.
+  void loadResources(const TextureAtlas &atlas);
+
+  void copySprites(SpriteList &out) const;
+
+  // Appends two triangles per sprite, interpolated alpha (0..1) of the way
+  // from the previous tick to the last one. Draw with getTexture().
+  void buildSprites(const SpriteList &sprites, float alpha,
+                    sf::VertexArray &out) const;
+
+  // Same, for translucent hitbox rects (F1)
+  void buildHitboxes(const SpriteList &sprites, float alpha,
+                     sf::VertexArray &out) const;
+
+  const sf::Texture *getTexture() const { return mTexture; }
+
+private:
+  // Bits of mFlags
+  enum : std::uint8_t {
+    GROUNDED = 1 << 0,
+    WALL_SLIDING = 1 << 1,
+    JUMP_HELD = 1 << 2, // Jump was pressed last tick (rising edge detection)
+    FACING_RIGHT = 1 << 3,
+    DEAD = 1 << 4
+  };
+
+  // Bits of mInput
+  enum : std::uint8_t {
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_JUMP = 1 << 2
+  };
+
+  // Systems, each one pass over the columns. Control and physics only
+  // write the entity they are looking at, so they run in batches on the
+  // job system.
+  static constexpr std::size_t BATCH_SIZE = 1024;
+  void controlSystem(float dt, const Map &map);
+  void controlBatch(std::size_t begin, std::size_t end, float dt,
+                    const Map &map);
+  void physicsSystem(float dt, const Map &map);
+  void physicsBatch(std::size_t begin, std::size_t end, float dt,
+                    const Map &map);
+  void contactSystem(); // Rebuilds the broadphase and resolves overlaps
+  void animationSystem(float dt);
+
+  void kill(std::size_t index); // Marks for removeDead()
+  void removeDead();
+
+  std::size_t indexOf(EntityId id) const { return mSlotIndex[id.slot]; }
+
+  std::size_t mCapacity;
+
+  // Dense component columns
+  std::vector<EntityKind> mKind;
+  std::vector<float> mPosX, mPosY;   // Hitbox top-left
+  std::vector<float> mPrevX, mPrevY; // Hitbox top-left before the last tick
+  std::vector<float> mVelX, mVelY;
+  std::vector<std::uint8_t> mFlags;
+  std::vector<std::int8_t> mWallDir; // -1 left, 1 right, 0 none
+  std::vector<std::uint8_t> mInput;
+  std::vector<std::uint8_t> mFrame;
+  std::vector<float> mAnimTimer;
+  std::vector<std::uint32_t> mSlot; // Dense index -> slot
+
+  // Slot table (EntityId::slot -> dense index)
+  std::vector<std::uint32_t> mSlotIndex;
+  std::vector<std::uint32_t> mSlotGeneration;
+  std::vector<std::uint32_t> mFreeSlots;
+  std::atomic<std::size_t> mDeadCount{0}; // Killed from physics batches
+
+  // Every entity's hitbox as of the last update, keyed by slot (slots
+  // survive the compaction in removeDead)
+  SpatialHash mBroadphase;
+
+  // Sprite frames in the atlas
+  const sf::Texture *mTexture = nullptr;
+  sf::IntRect mFrames[ENTITY_KIND_COUNT];
+};
+
+template <typename Visitor>
+void EntityWorld::queryBounds(const sf::FloatRect &bounds,
+                              Visitor &&visit) const {
+  mBroadphase.query(bounds, [&](std::uint32_t slot) {
+    EntityId id{slot, mSlotGeneration[slot]};
+    if (isAlive(id))
+      visit(id);
+  });
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+// Snapshot of the player controls for one simulation tick.
+// Filled from the keyboard in windowed mode, or from another source
+// (headless runs, replays) so Player never polls devices itself.
+struct PlayerInput {
+  bool left = false;
+  bool right = false;
+  bool jump = false;
+};
@@ -1,53 +1,382 @@
 #include "Game.hpp"
+#include "Core/Profiler.hpp"
+#include "Core/ResourceCache.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
 
 const sf::Time Game::TimePerFrame = sf::seconds(1.f / 60.f);
 
-Game::Game()
-    : mWindow(sf::VideoMode({1280, 720}), "Journey to the Clouds"),
-      mCamera({0.f, 0.f}, {640.f, 360.f}), mPlayer(), mMap(),
-      mBackgroundSprite(mBackgroundTexture) {
+namespace {
+
+// Prefer the precompiled .lvl next to a .tmx, unless the .tmx or one of
+// its external tilesets (whose tile properties the .lvl holds) is newer
+std::string resolveLevelPath(const std::string &filename) {
+  std::filesystem::path binary = std::filesystem::path(filename);
+  binary.replace_extension(".lvl");
+  std::error_code error;
+  if (binary.extension() == std::filesystem::path(filename).extension() ||
+      !std::filesystem::exists(binary, error))
+    return filename;
+
+  auto compiled = std::filesystem::last_write_time(binary, error);
+  if (error || std::filesystem::last_write_time(filename, error) > compiled)
+    return filename;
+  for (const std::string &tileset : Map::findTilesetFiles(filename)) {
+    if (std::filesystem::last_write_time(tileset, error) > compiled) {
+      std::cout << "Tileset " << tileset << " is newer than "
+                << binary.string() << ", loading the .tmx" << std::endl;
+      return filename;
+    }
+  }
+  return binary.string();
+}
+
+ParticleParams dustParams() {
+  ParticleParams params;
+  params.lifetime = 0.4f;
+  params.lifetimeVariance = 0.15f;
+  params.speed = 60.f;
+  params.speedVariance = 30.f;
+  params.spread = 0.35f;
+  params.gravity = 150.f;
+  params.drag = 4.f;
+  params.size = 3.f;
+  params.color = sf::Color(210, 200, 180, 200);
+  params.colorVariance = 60;
+  return params;
+}
 
-  if (!mBackgroundTexture.loadFromFile("assets/backgrounds/bg_bricks.png")) {
-    std::cerr << "Failed to load bg_bricks.png" << std::endl;
+ParticleParams sparkParams() {
+  ParticleParams params;
+  params.lifetime = 0.25f;
+  params.lifetimeVariance = 0.1f;
+  params.speed = 120.f;
+  params.speedVariance = 60.f;
+  params.spread = 0.6f;
+  params.gravity = 600.f;
+  params.drag = 1.f;
+  params.size = 2.f;
+  params.color = sf::Color(255, 220, 120);
+  params.colorVariance = 80;
+  return params;
+}
+
+ParticleParams burstParams() {
+  ParticleParams params;
+  params.lifetime = 1.f;
+  params.lifetimeVariance = 0.4f;
+  params.speed = 250.f;
+  params.speedVariance = 150.f;
+  params.gravity = 300.f;
+  params.drag = 1.5f;
+  params.size = 3.f;
+  params.color = sf::Color(255, 255, 180);
+  params.colorVariance = 120;
+  return params;
+}
+
+} // namespace
+
+Game::Game(const GameOptions &options)
+    : mOptions(options), mCamera({0.f, 0.f}, {640.f, 360.f}),
+      mPlayerId(mWorld.spawn(EntityKind::Player, {112.f, 16.f})),
+      mMap(std::make_unique<Map>()), mDust(dustParams()),
+      mSparks(sparkParams()), mBurst(burstParams()) {
+
+  // A replay always runs on the level it was recorded on. One that can't
+  // be read fails the run rather than falling back to live input, so a
+  // replay check never passes without verifying anything.
+  if (!mOptions.replayPath.empty()) {
+    if (!mReplayReader.open(mOptions.replayPath)) {
+      mReplayFailed = true;
+      return;
+    }
+    mOptions.levelPath = mReplayReader.getLevelPath();
+    std::cout << "Replaying " << mReplayReader.getTickCount()
+              << " ticks on " << mOptions.levelPath << std::endl;
+  }
+  if (!mOptions.recordPath.empty()) {
+    mReplayWriter.open(mOptions.recordPath, mOptions.levelPath);
+  }
+
+  // Headless runs never open a window or load anything for drawing
+  if (mOptions.headless) {
+    loadLevel(mOptions.levelPath);
+    return;
   }
 
-  // Enable texture repeating for tiled background
-  mBackgroundTexture.setRepeated(true);
-  mBackgroundSprite.setTexture(mBackgroundTexture, true);
+  mWindow.create(sf::VideoMode({1280, 720}), "Journey to the Clouds");
 
-  // Scale the background (2x for pixel art look)
-  mBackgroundSprite.setScale({2.f, 2.f});
+  // Pack the world textures so tiles and entities are drawn from one
+  // texture (background layers repeat, so they keep their own)
+  mAtlas.addImage("tileset", Map::TILESET_IMAGE);
+  mAtlas.addImage("player_idle", "assets/player/idle.png");
+  mAtlas.addImage("white", sf::Image({4, 4}, sf::Color::White));
+  mAtlas.build();
 
-  // Load font for FPS counter
-  mFPSFontLoaded = mFPSFont.openFromFile("assets/fonts/font.ttf");
+  mWorld.loadResources(mAtlas);
+
+  // Font for the HUD (shared with the map text)
+  mHudFont = Resources::fonts().get("assets/fonts/font.ttf");
+  if (mHudFont) {
+    mHudGlyphs.emplace(*mHudFont, 16, 1.f);
+    mProfilerOverlay.setFont(*mHudFont);
+  }
 
-  loadLevel("assets/maps/tutorial.tmx");
+  loadLevel(mOptions.levelPath);
+  publishSnapshot();
 
-  // Cap framerate at 60 FPS (use both methods for reliability)
-  mWindow.setFramerateLimit(60);
-  mWindow.setVerticalSyncEnabled(true);
+  if (mOptions.watchLevel) {
+    // Same restriction as requestLevel()
+    if (!mOptions.recordPath.empty() || !mOptions.replayPath.empty()) {
+      std::cerr << "Not watching the level while recording or replaying"
+                << std::endl;
+    } else if (mLevelWatcher.watch(mLevelPath)) {
+      std::cout << "Watching " << mLevelPath << " for changes" << std::endl;
+    }
+  }
+
+  applyFramePacing();
 }
 
-void Game::run() {
+int Game::run() {
+  if (mReplayFailed) {
+    return 1;
+  }
+  if (mOptions.headless) {
+    runHeadless();
+    return mReplayMismatches > 0 ? 1 : 0;
+  }
+
   sf::Clock clock;
   sf::Time timeSinceLastUpdate = sf::Time::Zero;
 
+  // Bounded catch-up: never owe more than MaxStepsPerFrame ticks
+  const sf::Time maxBacklog =
+      TimePerFrame * static_cast<std::int64_t>(MaxStepsPerFrame);
+
+  if (mOptions.threaded) {
+    mSimulationRunning = true;
+    mSimulationThread = std::thread(&Game::runSimulation, this);
+  }
+
   while (mWindow.isOpen()) {
     sf::Time dt = clock.restart();
-    timeSinceLastUpdate += dt;
+    timeSinceLastUpdate = std::min(timeSinceLastUpdate + dt, maxBacklog);
+
+    // Events once per frame, right before the ticks that consume them
+    processEvents();
+    pollLevelLoader();
+    pollLevelWatcher();
+
+    float alpha = 1.f;
+    if (!mOptions.threaded) {
+      applyControl();
+      while (timeSinceLastUpdate >= TimePerFrame) {
+        timeSinceLastUpdate -= TimePerFrame;
+        step(mLiveInput);
+      }
+      alpha = timeSinceLastUpdate / TimePerFrame;
+    }
+
+    mSnapshots.update();
+    const RenderSnapshot &snapshot = mSnapshots.front();
+    if (mOptions.threaded) {
+      // Time since the snapshot's tick, in ticks
+      std::chrono::duration<float> age =
+          std::chrono::steady_clock::now() - snapshot.time;
+      alpha = std::clamp(age.count() / TimePerFrame.asSeconds(), 0.f, 1.f);
+    }
+    render(snapshot, alpha);
+    waitForNextFrame();
+  }
 
-    while (timeSinceLastUpdate > TimePerFrame) {
-      timeSinceLastUpdate -= TimePerFrame;
+  if (mSimulationThread.joinable()) {
+    mSimulationRunning = false;
+    mSimulationThread.join();
+  }
+  mReplayWriter.close();
+  Resources::printStats(std::cout);
+  return mReplayMismatches > 0 ? 1 : 0;
+}
+
+void Game::runHeadless() {
+  // Fixed 60 Hz steps back to back, no pacing and no drawing.
+  // A replay runs for exactly its recorded length.
+  const PlayerInput idle;
+  int ticks = mReplayReader.isOpen()
+                  ? static_cast<int>(mReplayReader.getTickCount())
+                  : mOptions.ticks;
+  sf::Clock clock;
+
+  for (int tick = 0; tick < ticks; ++tick) {
+    step(idle);
+  }
+  if (mReplayReader.isOpen()) {
+    finishReplay();
+  }
+  mReplayWriter.close();
+
+  float seconds = clock.getElapsedTime().asSeconds();
+  sf::Vector2f pos = mWorld.getPosition(mPlayerId);
+  std::cout << "Simulated " << ticks << " ticks in " << seconds * 1000.f
+            << " ms";
+  if (seconds > 0.f) {
+    std::cout << " (" << static_cast<long long>(ticks / seconds)
+              << " ticks/s)";
+  }
+  std::cout << std::endl;
+  std::cout << "Final player position: " << pos.x << ", " << pos.y
+            << std::endl;
+  std::cout << "Final state hash: " << std::hex << hashPlayerState(mWorld, mPlayerId)
+            << std::dec << std::endl;
+}
 
-      processEvents();
-      update(TimePerFrame);
+void Game::runSimulation() {
+  // Fixed 60 Hz ticks against the wall clock, with the same bounded
+  // catch-up as the single-threaded loop
+  using Clock = std::chrono::steady_clock;
+  const auto tickDuration = std::chrono::duration_cast<Clock::duration>(
+      std::chrono::microseconds(TimePerFrame.asMicroseconds()));
+  auto nextTick = Clock::now();
+
+  while (mSimulationRunning.load(std::memory_order_relaxed)) {
+    applyControl();
+    step(mLiveInput);
+
+    nextTick += tickDuration;
+    auto now = Clock::now();
+    if (now - nextTick > tickDuration * MaxStepsPerFrame) {
+      nextTick = now;
     }
-    render();
+    std::this_thread::sleep_until(nextTick);
   }
 }
 
+void Game::applyControl() {
+  std::unique_ptr<Map> map;
+  bool reload = false;
+  int stressSpawns = 0;
+  {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    mLiveInput = mControl.input;
+    mResetRequested |= mControl.resetRequested;
+    mControl.resetRequested = false;
+    if (mControl.cameraSize) {
+      mCamera.setSize(*mControl.cameraSize);
+      mControl.cameraSize.reset();
+    }
+    map = std::move(mControl.pendingMap);
+    reload = mControl.pendingReload;
+    mControl.pendingReload = false;
+    stressSpawns = mControl.stressSpawns;
+    mControl.stressSpawns = 0;
+  }
+
+  if (map) {
+    setLevel(std::move(map), reload);
+  }
+  if (stressSpawns > 0) {
+    spawnStressEntities(stressSpawns);
+  }
+}
+
+void Game::publishSnapshot() {
+  RenderSnapshot &snapshot = mSnapshots.back();
+  snapshot.map = mMap;
+  snapshot.previousCameraCenter = mPreviousCameraCenter;
+  snapshot.cameraCenter = mCamera.getCenter();
+  snapshot.cameraSize = mCamera.getSize();
+  mWorld.copySprites(snapshot.sprites);
+  snapshot.time = std::chrono::steady_clock::now();
+
+  // Chunks for every camera position the renderer may interpolate to
+  sf::View previous(mPreviousCameraCenter, mCamera.getSize());
+  sf::IntRect a = mMap->getVisibleChunks(previous);
+  sf::IntRect b = mMap->getVisibleChunks(mCamera);
+  sf::Vector2i start(std::min(a.position.x, b.position.x),
+                     std::min(a.position.y, b.position.y));
+  sf::Vector2i end(std::max(a.position.x + a.size.x, b.position.x + b.size.x),
+                   std::max(a.position.y + a.size.y, b.position.y + b.size.y));
+  snapshot.visibleChunks = sf::IntRect(start, end - start);
+
+  mSnapshots.publish();
+}
+
+void Game::step(const PlayerInput &liveInput) {
+  ReplayTick tick;
+  tick.input = liveInput;
+  tick.reset = mResetRequested;
+  mResetRequested = false;
+
+  // Replayed ticks override the live input entirely
+  ReplayTick recorded;
+  bool replaying = mReplayReader.isOpen() && mReplayReader.readTick(recorded);
+  if (replaying) {
+    tick.input = recorded.input;
+    tick.reset = recorded.reset;
+  } else if (mReplayReader.isOpen()) {
+    finishReplay();
+  }
+
+  if (tick.reset) {
+    mCheckpoint.reset();
+    mWorld.reset(mPlayerId, mMap->getStartPosition());
+  }
+  update(TimePerFrame, tick.input);
+  tick.stateHash = hashPlayerState(mWorld, mPlayerId);
+
+  if (replaying && tick.stateHash != recorded.stateHash) {
+    if (mReplayMismatches == 0) {
+      mFirstMismatchTick = mTick;
+    }
+    ++mReplayMismatches;
+  }
+  if (mReplayWriter.isOpen()) {
+    mReplayWriter.writeTick(tick);
+  }
+  ++mTick;
+
+  if (!mOptions.headless) {
+    publishSnapshot();
+  }
+}
+
+void Game::finishReplay() {
+  if (mReplayMismatches == 0) {
+    std::cout << "Replay OK: " << mReplayReader.getTicksRead()
+              << " ticks matched" << std::endl;
+  } else {
+    std::cout << "Replay DIVERGED at tick " << mFirstMismatchTick << " ("
+              << mReplayMismatches << " of " << mReplayReader.getTicksRead()
+              << " ticks differ)" << std::endl;
+  }
+  mReplayReader.close();
+}
+
+PlayerInput Game::readKeyboardInput() const {
+  PlayerInput input;
+  input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left) ||
+               sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A);
+  input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right) ||
+                sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D);
+  input.jump = sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Space) ||
+               sf::Keyboard::isKeyPressed(sf::Keyboard::Key::W);
+  return input;
+}
+
 void Game::processEvents() {
+  PROFILE_ZONE("processEvents");
+
+  // Held keys are sampled once per frame for the ticks that follow
+  PlayerInput input = readKeyboardInput();
+  {
+    std::lock_guard<std::mutex> lock(mControlMutex);
+    mControl.input = input;
+  }
+
   while (const std::optional event = mWindow.pollEvent()) {
     if (event->is<sf::Event::Closed>()) {
       mWindow.close();
@@ -58,13 +387,15 @@ void Game::processEvents() {
       sf::Vector2f newSize(static_cast<float>(resized->size.x),
                            static_cast<float>(resized->size.y));
       // Maintain 2x Zoom
-      mCamera.setSize({newSize.x / 2.f, newSize.y / 2.f});
+      resizeCamera({newSize.x / 2.f, newSize.y / 2.f});
     }
 
     // Key Presses
     if (const auto *keyPress = event->getIf<sf::Event::KeyPressed>()) {
       if (keyPress->code == sf::Keyboard::Key::R) {
-        mPlayer.reset(mMap.getStartPosition());
+        // Applied (and recorded) on the next tick
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        mControl.resetRequested = true;
       }
       // F1 - Toggle hitbox visibility
       if (keyPress->code == sf::Keyboard::Key::F1) {
@@ -74,37 +405,91 @@ void Game::processEvents() {
       if (keyPress->code == sf::Keyboard::Key::F2) {
         mShowFPS = !mShowFPS;
       }
+      // F3 - Toggle profiler overlay, Ctrl+F3 - dump a Chrome trace
+      if (keyPress->code == sf::Keyboard::Key::F3) {
+        if (keyPress->control) {
+          Profiler::writeChromeTrace("profile.json");
+        } else {
+          mShowProfiler = !mShowProfiler;
+        }
+      }
       // F4 - Cycle window mode
       if (keyPress->code == sf::Keyboard::Key::F4) {
         cycleWindowMode();
       }
+      // F5 - Reload the level without stopping the game
+      if (keyPress->code == sf::Keyboard::Key::F5) {
+        requestLevel(mLevelPath);
+      }
+      // F6 - Spawn 1000 stress-test entities
+      if (keyPress->code == sf::Keyboard::Key::F6) {
+        std::lock_guard<std::mutex> lock(mControlMutex);
+        mControl.stressSpawns += 1000;
+      }
     }
   }
 }
 
-void Game::update(sf::Time dt) {
-  mPlayer.update(dt.asSeconds(), mMap);
+void Game::update(sf::Time dt, const PlayerInput &input) {
+  PROFILE_ZONE("update");
+  bool wasGrounded = mWorld.isOnGround(mPlayerId);
+  mWorld.setInput(mPlayerId, input);
+
+  // Infinite maps: load what the camera is about to reach
+  mMap->updateStreaming(mCamera);
+  mWorld.update(dt.asSeconds(), *mMap);
+
+  // Dust where the player lands, sparks off the wall while sliding
+  sf::FloatRect bounds = mWorld.getBounds(mPlayerId);
+  sf::Vector2f feet(bounds.position.x + bounds.size.x / 2.f,
+                    bounds.position.y + bounds.size.y);
+  if (!wasGrounded && mWorld.isOnGround(mPlayerId)) {
+    queueEffect(Effect::Landing, feet, {-1.f, 0.f});
+    queueEffect(Effect::Landing, feet, {1.f, 0.f});
+  }
+  if (mWorld.isOnWall(mPlayerId)) {
+    float wallDir = static_cast<float>(mWorld.getWallDir(mPlayerId));
+    queueEffect(Effect::WallSlide,
+                {feet.x + wallDir * bounds.size.x / 2.f, feet.y},
+                {-wallDir, -1.f});
+  }
 
-  // Death Logic (Falling off map)
-  if (mPlayer.getPosition().y > mMap.getHeight() + 200.f) {
-    mPlayer.reset(mMap.getStartPosition());
+  // Map objects touched: checkpoints move the respawn point, kill zones
+  // count as a death
+  bool killed = false;
+  mMap->forEachObject(bounds, [&](const MapObject &object) {
+    if (object.type == MapObjectType::KillZone)
+      killed = true;
+    else if (object.type == MapObjectType::Checkpoint)
+      mCheckpoint = object.bounds.position + object.bounds.size / 2.f;
+  });
+
+  // Death Logic (Falling off map, or touching a hazard or kill zone)
+  if (killed || mWorld.getPosition(mPlayerId).y > mMap->getHeight() + 200.f ||
+      mMap->checkHazard(bounds)) {
+    mWorld.reset(mPlayerId, mCheckpoint.value_or(mMap->getStartPosition()));
   }
 
   // Finish Logic
-  if (mMap.checkFinish(mPlayer.getBounds())) {
+  sf::FloatRect finishBounds = mWorld.getBounds(mPlayerId);
+  if (mMap->checkFinish(finishBounds)) {
     std::cout << "Level Finished! Resetting..." << std::endl;
-    mPlayer.reset(mMap.getStartPosition());
+    queueEffect(Effect::Finish,
+                finishBounds.position + finishBounds.size / 2.f);
+    mCheckpoint.reset();
+    mWorld.reset(mPlayerId, mMap->getStartPosition());
   }
 
   // Camera Logic
-  sf::Vector2f playerPos = mPlayer.getPosition();
+  mPreviousCameraCenter = mCamera.getCenter();
+  sf::Vector2f playerPos = mWorld.getPosition(mPlayerId);
   sf::Vector2f viewSize = mCamera.getSize();
   sf::Vector2f currentCenter = mCamera.getCenter();
 
   float targetX, targetY;
 
   // Calculate TARGET X (Clamped to map)
-  float mapW = mMap.getWidth();
+  float mapW = mMap->getWidth();
   if (mapW < viewSize.x) {
     targetX = mapW / 2.f;
   } else {
@@ -113,7 +498,7 @@ void Game::update(sf::Time dt) {
   }
 
   // Calculate TARGET Y (Clamped to map)
-  float mapH = mMap.getHeight();
+  float mapH = mMap->getHeight();
   if (mapH < viewSize.y) {
     targetY = mapH / 2.f;
   } else {
@@ -130,47 +515,40 @@ void Game::update(sf::Time dt) {
                (targetY - currentCenter.y) * lerpSpeed * dt.asSeconds();
 
   mCamera.setCenter({newX, newY});
-  mWindow.setView(mCamera);
 }
 
-void Game::render() {
+void Game::render(const RenderSnapshot &snapshot, float alpha) {
   mWindow.clear(sf::Color(50, 50, 80)); // Dark blue fallback color
 
-  // Set world view for all game elements
-  mWindow.setView(mCamera);
-
-  // Parallax background - scroll texture based on camera position
-  // Factor 0.3 = background moves at 30% of camera speed (further away =
-  // slower)
-  float parallaxFactor = 0.3f;
-  sf::Vector2f cameraCenter = mCamera.getCenter();
-  sf::Vector2f viewSize = mCamera.getSize();
-  float bgScale = mBackgroundSprite.getScale().x;
-
-  // Calculate texture offset for parallax (scroll the texture)
-  int texOffsetX =
-      static_cast<int>((cameraCenter.x * parallaxFactor) / bgScale);
-  int texOffsetY =
-      static_cast<int>((cameraCenter.y * parallaxFactor) / bgScale);
-
-  // Size of visible area in texture coordinates
-  int texWidth = static_cast<int>(viewSize.x / bgScale) + 64; // Extra margin
-  int texHeight = static_cast<int>(viewSize.y / bgScale) + 64;
-
-  // Update texture rect with parallax offset
-  mBackgroundSprite.setTextureRect(
-      sf::IntRect({texOffsetX, texOffsetY}, {texWidth, texHeight}));
-
-  // Position sprite at camera top-left corner
-  mBackgroundSprite.setPosition(
-      {cameraCenter.x - viewSize.x / 2.f, cameraCenter.y - viewSize.y / 2.f});
-
-  // Draw tiled background (behind everything)
-  mWindow.draw(mBackgroundSprite);
-
-  // Draw map and player
-  mMap.render(mWindow);
-  mPlayer.render(mWindow, mShowHitbox);
+  // Set world view for all game elements, between the last two ticks
+  sf::View view(snapshot.previousCameraCenter +
+                    (snapshot.cameraCenter - snapshot.previousCameraCenter) *
+                        alpha,
+                snapshot.cameraSize);
+  mWindow.setView(view);
+
+  // Draw the level's image layers (behind everything), the map, then
+  // every entity in one batch
+  if (snapshot.map) {
+    snapshot.map->renderBackground(mWindow, view);
+    snapshot.map->render(mWindow, snapshot.visibleChunks);
+  }
+  mEntitySprites.clear();
+  mWorld.buildSprites(snapshot.sprites, alpha, mEntitySprites);
+  sf::RenderStates entityStates;
+  entityStates.texture = mWorld.getTexture();
+  mWindow.draw(mEntitySprites, entityStates);
+
+  updateParticles();
+  mDust.draw(mWindow);
+  mSparks.draw(mWindow);
+  mBurst.draw(mWindow);
+
+  if (mShowHitbox) {
+    mHitboxes.clear();
+    mWorld.buildHitboxes(snapshot.sprites, alpha, mHitboxes);
+    mWindow.draw(mHitboxes);
+  }
 
   // FPS Counter
   mFrameCount++;
@@ -181,51 +559,246 @@ void Game::render() {
     mFPSClock.restart();
   }
 
-  // Draw FPS (in screen space)
-  if (mShowFPS && mFPSFontLoaded) {
+  // FPS and loading indicator (in screen space)
+  updateHud();
+  if (!mHudText.empty()) {
     mWindow.setView(mWindow.getDefaultView());
-    sf::Text fpsText(mFPSFont);
-    fpsText.setString(std::to_string(mCurrentFPS));
-    fpsText.setCharacterSize(16);
-    fpsText.setFillColor(sf::Color::Green);
-    fpsText.setOutlineColor(sf::Color::Black);
-    fpsText.setOutlineThickness(1.f);
-    // Position at top-right
-    float textWidth = fpsText.getLocalBounds().size.x;
-    fpsText.setPosition({mWindow.getSize().x - textWidth - 10.f, 10.f});
-    mWindow.draw(fpsText);
+    mHudText.draw(mWindow);
+  }
+
+  // Profiler overlay (in screen space)
+  if (mShowProfiler) {
+    mWindow.setView(mWindow.getDefaultView());
+    mProfilerOverlay.draw(mWindow);
+  }
+
+  {
+    PROFILE_ZONE("display");
+    mWindow.display();
+  }
+  Profiler::endFrame();
+}
+
+void Game::queueEffect(Effect effect, sf::Vector2f position,
+                       sf::Vector2f direction) {
+  if (mOptions.headless) {
+    return; // Nobody to draw them
+  }
+  std::lock_guard<std::mutex> lock(mEffectMutex);
+  mQueuedEffects.push_back({effect, position, direction});
+}
+
+void Game::updateParticles() {
+  PROFILE_ZONE("particles");
+  {
+    std::lock_guard<std::mutex> lock(mEffectMutex);
+    mSpawningEffects.swap(mQueuedEffects);
+  }
+  for (const QueuedEffect &queued : mSpawningEffects) {
+    switch (queued.effect) {
+    case Effect::Landing:
+      mDust.emit(queued.position, queued.direction, 12);
+      break;
+    case Effect::WallSlide:
+      mSparks.emit(queued.position, queued.direction, 2);
+      break;
+    case Effect::Finish:
+      mBurst.emit(queued.position, queued.direction, 400);
+      break;
+    }
   }
+  mSpawningEffects.clear();
 
-  mWindow.display();
+  // Frame time, capped so a stall doesn't fling particles across the level
+  float dt = std::min(mParticleClock.restart().asSeconds(), 0.1f);
+  mDust.update(dt);
+  mSparks.update(dt);
+  mBurst.update(dt);
+}
+
+void Game::updateHud() {
+  if (!mHudGlyphs)
+    return;
+
+  int fps = mShowFPS ? mCurrentFPS : -1;
+  int loadPercent = mLevelLoader.isLoading()
+                        ? static_cast<int>(mLevelLoader.getProgress() * 100.f)
+                        : -1;
+  sf::Vector2u windowSize = mWindow.getSize();
+  if (fps == mHudFPS && loadPercent == mHudLoadPercent &&
+      windowSize == mHudWindowSize) {
+    return;
+  }
+  mHudFPS = fps;
+  mHudLoadPercent = loadPercent;
+  mHudWindowSize = windowSize;
+
+  mHudText.clear();
+  char label[32];
+  if (loadPercent >= 0) {
+    std::snprintf(label, sizeof(label), "Loading %d%%", loadPercent);
+    mHudText.append(*mHudGlyphs, label, {10.f, windowSize.y - 30.f});
+  }
+  if (fps >= 0) {
+    // Top-right corner
+    std::snprintf(label, sizeof(label), "%d", fps);
+    float width = mHudText.measure(*mHudGlyphs, label).x;
+    mHudText.append(*mHudGlyphs, label, {windowSize.x - width - 10.f, 10.f},
+                    sf::Color::Green);
+  }
+}
+
+std::unique_ptr<Map> Game::createMap() {
+  auto map = std::make_unique<Map>();
+  if (!mOptions.headless) {
+    map->loadResources(mAtlas);
+  }
+
+  StreamSettings settings;
+  settings.radius = mOptions.streamRadius;
+  settings.memoryBudget = static_cast<std::size_t>(mOptions.streamBudgetMB)
+                          << 20;
+  // Chunks arriving on their own schedule would change what the player
+  // collides with between runs
+  settings.synchronous =
+      !mOptions.recordPath.empty() || !mOptions.replayPath.empty();
+  map->setStreamSettings(settings);
+  return map;
 }
 
 void Game::loadLevel(const std::string &filename) {
-  // Only reload if needed, but for now simple reload
-  if (mMap.loadFromFile(filename)) {
-    mPlayer.reset(mMap.getStartPosition());
-
-    sf::Vector2f playerPos = mPlayer.getPosition();
-    sf::Vector2f viewSize = mCamera.getSize();
-    float mapW = mMap.getWidth();
-    float mapH = mMap.getHeight();
-
-    float camX = std::max(playerPos.x, viewSize.x / 2.f);
-    camX = std::min(camX, mapW - viewSize.x / 2.f);
-    float camY = std::max(playerPos.y, viewSize.y / 2.f);
-    camY = std::min(camY, mapH - viewSize.y / 2.f);
-    mCamera.setCenter({camX, camY});
-
-    // Set background texture rect to cover the map
-    float bgScale = mBackgroundSprite.getScale().x;
-    int texWidth = static_cast<int>((mMap.getWidth() * 1.0f) / bgScale);
-    int texHeight = static_cast<int>((mMap.getHeight() * 1.0f) / bgScale);
-    mBackgroundSprite.setTextureRect(
-        sf::IntRect({0, 0}, {texWidth, texHeight}));
+  std::unique_ptr<Map> map = createMap();
+  if (map->loadFromFile(resolveLevelPath(filename))) {
+    mLevelPath = filename;
+    setLevel(std::move(map));
   } else {
     std::cerr << "Failed to load level: " << filename << std::endl;
   }
 }
 
+void Game::requestLevel(const std::string &filename) {
+  // A level swap at an arbitrary tick can't be replayed, so recordings and
+  // replays only ever use the level they started on
+  if (!mOptions.recordPath.empty() || !mOptions.replayPath.empty() ||
+      mLevelLoader.isLoading()) {
+    return;
+  }
+  mLevelLoader.start(createMap(), resolveLevelPath(filename));
+  mLevelPath = filename;
+}
+
+void Game::pollLevelLoader() {
+  if (!mLevelLoader.isReady()) {
+    return;
+  }
+
+  std::unique_ptr<Map> map = mLevelLoader.take();
+  std::shared_ptr<const Map> base = std::move(mReloadBase);
+  if (!map) {
+    std::cerr << "Failed to load level: " << mLevelLoader.getFilename()
+              << std::endl;
+    return;
+  }
+
+  bool reload = base != nullptr;
+  if (reload) {
+    // Only the chunks whose tiles changed get new meshes. The base map is
+    // drawn on this thread, so its meshes are read here, not on the loader.
+    size_t reused = map->reuseTileMeshes(*base);
+    map->buildTileMeshes();
+    std::cout << "Reloaded " << mLevelPath << " in "
+              << mReloadClock.getElapsedTime().asMilliseconds() << " ms ("
+              << reused << " chunk meshes reused)" << std::endl;
+  }
+
+  // Text layout needs the main thread; the swap itself happens on the
+  // simulation side at the next tick
+  map->prepareGraphics();
+  std::lock_guard<std::mutex> lock(mControlMutex);
+  mControl.pendingMap = std::move(map);
+  mControl.pendingReload = reload;
+}
+
+void Game::pollLevelWatcher() {
+  if (mLevelWatcher.poll()) {
+    mReloadPending = true;
+  }
+  // A save during a load is picked up once it finishes
+  if (!mReloadPending || mLevelLoader.isLoading()) {
+    return;
+  }
+  mReloadPending = false;
+
+  // Diff against the map on screen: its grids are never modified after
+  // loading, so the loader can read them while it is still drawn
+  mReloadBase = mSnapshots.front().map;
+  mReloadClock.restart();
+  mLevelLoader.start(createMap(), mLevelWatcher.getPath(), mReloadBase);
+}
+
+void Game::setLevel(std::unique_ptr<Map> map, bool reload) {
+  bool keepPlayer =
+      reload && mMap && map->getStartPosition() == mMap->getStartPosition();
+  mMap = std::move(map);
+  mCheckpoint.reset();
+
+  // Forget cache entries for assets the previous level no longer holds
+  Resources::textures().releaseUnused();
+  Resources::fonts().releaseUnused();
+
+  if (keepPlayer) {
+    return;
+  }
+
+  // Entities belong to the level they were spawned in
+  mWorld.clearExcept(mPlayerId);
+  mWorld.reset(mPlayerId, mMap->getStartPosition());
+
+  sf::Vector2f playerPos = mWorld.getPosition(mPlayerId);
+  sf::Vector2f viewSize = mCamera.getSize();
+  float mapW = mMap->getWidth();
+  float mapH = mMap->getHeight();
+
+  float camX = std::max(playerPos.x, viewSize.x / 2.f);
+  camX = std::min(camX, mapW - viewSize.x / 2.f);
+  float camY = std::max(playerPos.y, viewSize.y / 2.f);
+  camY = std::min(camY, mapH - viewSize.y / 2.f);
+  mCamera.setCenter({camX, camY});
+  mPreviousCameraCenter = mCamera.getCenter();
+}
+
+void Game::spawnStressEntities(int count) {
+  sf::Vector2f center = mWorld.getBounds(mPlayerId).getCenter();
+
+  // Cheap LCG; placement only has to look scattered
+  auto random = [this](float range) {
+    mSpawnSeed = mSpawnSeed * 1664525u + 1013904223u;
+    return (static_cast<float>(mSpawnSeed >> 8) / 16777216.f * 2.f - 1.f) *
+           range;
+  };
+
+  for (int i = 0; i < count; ++i) {
+    sf::Vector2f position(center.x + random(400.f),
+                          center.y - 100.f + random(60.f));
+    EntityKind kind = i % 10 < 5   ? EntityKind::Enemy
+                      : i % 10 < 8 ? EntityKind::Pickup
+                                   : EntityKind::Projectile;
+    sf::Vector2f velocity;
+    if (kind == EntityKind::Pickup) {
+      velocity = {random(150.f), -200.f + random(100.f)};
+    } else if (kind == EntityKind::Projectile) {
+      velocity = {random(1.f) < 0.f ? -400.f : 400.f, 0.f};
+    } else {
+      velocity = {random(1.f) < 0.f ? -1.f : 1.f, 0.f};
+    }
+
+    if (!mWorld.spawn(kind, position, velocity).isValid()) {
+      break; // World is full
+    }
+  }
+  std::cout << "Entities: " << mWorld.size() << std::endl;
+}
+
 void Game::cycleWindowMode() {
   mWindowMode = (mWindowMode + 1) % 3;
 
@@ -247,9 +820,50 @@ void Game::cycleWindowMode() {
 
   // Restore camera size based on new window size
   sf::Vector2u winSize = mWindow.getSize();
-  mCamera.setSize({winSize.x / 2.f, winSize.y / 2.f});
+  resizeCamera({winSize.x / 2.f, winSize.y / 2.f});
+
+  // Restore frame pacing
+  applyFramePacing();
+}
+
+void Game::applyFramePacing() {
+  // The limiter is done by hand: SFML's setFramerateLimit only sleeps,
+  // which overshoots by up to a scheduler quantum
+  mWindow.setFramerateLimit(0);
+  mWindow.setVerticalSyncEnabled(mOptions.pacing == FramePacing::VSync);
+  mPacingClock.restart();
+  mNextFrame = sf::Time::Zero;
+}
+
+void Game::waitForNextFrame() {
+  if (mOptions.pacing != FramePacing::Limited || mOptions.frameLimit <= 0) {
+    return;
+  }
+
+  // The deadline advances by exactly one frame, so the overshoot of one
+  // wait is taken out of the next instead of adding up. A frame that
+  // overran resyncs it rather than letting the next ones rush to catch up.
+  const sf::Time target = sf::seconds(1.f / mOptions.frameLimit);
+  mNextFrame += target;
+  sf::Time now = mPacingClock.getElapsedTime();
+  if (now >= mNextFrame) {
+    mNextFrame = now;
+    return;
+  }
+
+  // Sleep through most of the remaining frame, then spin for the last
+  // couple of milliseconds where sleep is too coarse
+  const sf::Time spinMargin = sf::milliseconds(2);
+  sf::Time remaining = mNextFrame - now;
+  if (remaining > spinMargin) {
+    sf::sleep(remaining - spinMargin);
+  }
+  while (mPacingClock.getElapsedTime() < mNextFrame) {
+  }
+}
 
-  // Restore FPS limit
-  mWindow.setFramerateLimit(60);
-  mWindow.setVerticalSyncEnabled(true);
+void Game::resizeCamera(sf::Vector2f size) {
+  // The camera belongs to the simulation; it picks the size up next tick
+  std::lock_guard<std::mutex> lock(mControlMutex);
+  mControl.cameraSize = size;
 }
@@ -1,42 +1,247 @@
 #pragma once
 
-#include "Entities/Player.hpp"
+#include "Core/FileWatcher.hpp"
+#include "Core/Replay.hpp"
+#include "Core/TripleBuffer.hpp"
+#include "Entities/EntityWorld.hpp"
+#include "Graphics/ParticleEmitter.hpp"
+#include "Graphics/ProfilerOverlay.hpp"
+#include "Graphics/TextLayout.hpp"
+#include "Graphics/TextureAtlas.hpp"
+#include "World/LevelLoader.hpp"
 #include "World/Map.hpp"
 #include <SFML/Graphics.hpp>
 #include <SFML/Window.hpp>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// How the windowed loop paces frames
+enum class FramePacing {
+  VSync,    // Wait for the display's refresh
+  Uncapped, // Render as fast as possible
+  Limited   // Sleep, then spin, to hit GameOptions::frameLimit exactly
+};
+
+// Startup options, filled from the command line in main.cpp
+struct GameOptions {
+  std::string levelPath = "assets/maps/tutorial.tmx";
+
+  // Headless mode: no window, no textures; step the simulation as fast as
+  // the CPU allows for the given number of ticks
+  bool headless = false;
+  int ticks = 3600;
+
+  // Record every tick's input (and resulting state hash) to this file
+  std::string recordPath;
+
+  // Play back a recording instead of reading the keyboard, verifying the
+  // state hash of every tick. Real-time with a window, max speed headless.
+  std::string replayPath;
+
+  FramePacing pacing = FramePacing::VSync;
+  int frameLimit = 144; // Frames per second for FramePacing::Limited
+
+  // Run the simulation on its own thread at a steady 60 Hz, so a slow
+  // frame (vsync wait, text layout) never delays a tick
+  bool threaded = false;
+
+  // Reload the level in the background whenever its file is saved,
+  // keeping the player where it is unless the spawn moved
+  bool watchLevel = false;
+
+  // Infinite maps: chunks kept loaded beyond the view, on every side, and
+  // the memory they may take
+  int streamRadius = 4;
+  int streamBudgetMB = 32;
+};
+
+// What drawing needs from one simulation tick. The simulation publishes one
+// after every tick and the main thread draws the newest, so rendering never
+// reads live simulation state.
+struct RenderSnapshot {
+  std::shared_ptr<Map> map; // Keeps a swapped-out level alive while drawn
+  sf::Vector2f previousCameraCenter;
+  sf::Vector2f cameraCenter;
+  sf::Vector2f cameraSize;
+  SpriteList sprites;
+  sf::IntRect visibleChunks; // Covers both camera positions
+  std::chrono::steady_clock::time_point time; // When the tick finished
+};
 
 class Game {
 public:
-  Game();
-  void run();
+  explicit Game(const GameOptions &options = GameOptions());
+
+  // Returns the process exit code (non-zero if a replay diverged)
+  int run();
 
 private:
+  void runHeadless();
+  void runSimulation(); // Simulation thread body (GameOptions::threaded)
   void processEvents();
-  void update(sf::Time dt);
-  void render();
+  PlayerInput readKeyboardInput() const;
+
+  // One fixed tick: picks the input (live or replayed), applies pending
+  // resets, updates, then records/verifies the resulting state hash
+  void step(const PlayerInput &liveInput);
+  void finishReplay();
+
+  // Simulation side of the mailbox below: takes the latest input, reset
+  // request, camera size and swapped-in level at a tick boundary
+  void applyControl();
+  void publishSnapshot();
+
+  void update(sf::Time dt, const PlayerInput &input);
+  // alpha is the fraction of a tick since the snapshot's tick, used to
+  // interpolate the player and camera between their last two states
+  void render(const RenderSnapshot &snapshot, float alpha);
+  void updateHud(); // Rebuilds mHudText if its values changed
+
+  // Particle effects: the simulation queues them, the main thread spawns
+  // and steps them with the frame time
+  enum class Effect : std::uint8_t { Landing, WallSlide, Finish };
+  void queueEffect(Effect effect, sf::Vector2f position,
+                   sf::Vector2f direction = {0.f, -1.f});
+  void updateParticles();
+
+  void applyFramePacing();
+  void waitForNextFrame(); // FramePacing::Limited only
+
+  // An empty map set up with the atlas (unless headless) and the stream
+  // settings, ready to load into
+  std::unique_ptr<Map> createMap();
+
+  // Blocking load, used at startup
   void loadLevel(const std::string &filename);
+
+  // Background load: the current level keeps running until the new one is
+  // ready, then pollLevelLoader() hands it to the simulation, which swaps
+  // it in between ticks
+  void requestLevel(const std::string &filename);
+  void pollLevelLoader();
+
+  // GameOptions::watchLevel: starts a background reload of the current
+  // level when its file changes, diffed against the map on screen
+  void pollLevelWatcher();
+
+  // Makes a loaded map current and respawns the player on it. A reload
+  // of the current level keeps the player and entities instead, unless
+  // the spawn moved.
+  void setLevel(std::unique_ptr<Map> map, bool reload = false);
+
+  // F6 - drops a batch of enemies, projectiles and pickups around the
+  // player to load-test the entity systems
+  void spawnStressEntities(int count);
+
   void cycleWindowMode(); // F4 - cycle through window modes
+  void resizeCamera(sf::Vector2f size);
+
+  GameOptions mOptions;
 
   sf::RenderWindow mWindow;
   sf::View mCamera;
+  sf::Vector2f mPreviousCameraCenter; // Camera center before the last tick
+
+  EntityWorld mWorld;
+  EntityId mPlayerId;
+  std::shared_ptr<Map> mMap;
+  std::string mLevelPath;
+  LevelLoader mLevelLoader;
+
+  // Hot reload (GameOptions::watchLevel)
+  FileWatcher mLevelWatcher;
+  bool mReloadPending = false; // Changed while the loader was busy
+  std::shared_ptr<const Map> mReloadBase; // Map the running reload diffs
+  sf::Clock mReloadClock;
 
-  Player mPlayer;
-  Map mMap;
+  // Every world texture (tiles, player) packed into one page
+  TextureAtlas mAtlas;
 
-  sf::Texture mBackgroundTexture;
-  sf::Sprite mBackgroundSprite;
+  // Entity sprites (and F1 hitboxes), rebuilt from the snapshot each frame
+  sf::VertexArray mEntitySprites{sf::PrimitiveType::Triangles};
+  sf::VertexArray mHitboxes{sf::PrimitiveType::Triangles};
+
+  // Effects, one draw call each
+  ParticleEmitter mDust;   // Landing
+  ParticleEmitter mSparks; // Wall slide
+  ParticleEmitter mBurst;  // Level finished
+  sf::Clock mParticleClock;
 
   static const sf::Time TimePerFrame;
 
+  // Most ticks simulated per rendered frame; after a longer stall the
+  // remaining backlog is dropped instead of spiralling
+  static constexpr int MaxStepsPerFrame = 5;
+  sf::Clock mPacingClock;
+  sf::Time mNextFrame; // Limiter deadline, on mPacingClock
+
+  // Main thread -> simulation mailbox, applied at the start of a tick
+  struct SimControl {
+    PlayerInput input;
+    bool resetRequested = false;
+    std::optional<sf::Vector2f> cameraSize;
+    std::unique_ptr<Map> pendingMap;
+    bool pendingReload = false; // pendingMap is a reload of the level
+    int stressSpawns = 0;
+  };
+  std::mutex mControlMutex;
+  SimControl mControl;
+  PlayerInput mLiveInput; // Simulation's copy of SimControl::input
+
+  // Simulation -> main thread
+  TripleBuffer<RenderSnapshot> mSnapshots;
+
+  // Simulation -> main thread effects. Queued rather than put in the
+  // snapshot, so effects of ticks the renderer skipped aren't lost.
+  struct QueuedEffect {
+    Effect effect;
+    sf::Vector2f position;
+    sf::Vector2f direction;
+  };
+  std::mutex mEffectMutex;
+  std::vector<QueuedEffect> mQueuedEffects;
+  std::vector<QueuedEffect> mSpawningEffects; // Main thread's swap target
+  std::thread mSimulationThread;
+  std::atomic<bool> mSimulationRunning{false};
+
+  // Recording / replay
+  ReplayWriter mReplayWriter;
+  ReplayReader mReplayReader;
+  bool mReplayFailed = false; // --replay given but unreadable
+  bool mResetRequested = false; // R pressed, applied on the next tick
+  // Last checkpoint object touched; deaths respawn there, not at the start
+  std::optional<sf::Vector2f> mCheckpoint;
+  std::uint32_t mTick = 0;
+  std::uint32_t mReplayMismatches = 0;
+  std::uint32_t mFirstMismatchTick = 0;
+
+  std::uint32_t mSpawnSeed = 1; // Placement of stress entities
+
   // Debug features
-  bool mShowHitbox = false; // F1 toggle
-  bool mShowFPS = false;    // F2 toggle
-  int mWindowMode = 0;      // 0=windowed, 1=maximized, 2=fullscreen
+  bool mShowHitbox = false;   // F1 toggle
+  bool mShowFPS = false;      // F2 toggle
+  bool mShowProfiler = false; // F3 toggle (Ctrl+F3 writes a trace)
+  int mWindowMode = 0;        // 0=windowed, 1=maximized, 2=fullscreen
 
   // FPS counter
-  sf::Font mFPSFont;
-  bool mFPSFontLoaded = false;
   sf::Clock mFPSClock;
   int mFrameCount = 0;
   int mCurrentFPS = 0;
+
+  // HUD text (FPS counter, loading indicator) in one batch, laid out again
+  // only when what it shows changes
+  std::shared_ptr<sf::Font> mHudFont;
+  std::optional<GlyphCache> mHudGlyphs;
+  TextBatch mHudText;
+  int mHudFPS = -1; // Values on display, -1 when hidden
+  int mHudLoadPercent = -1;
+  sf::Vector2u mHudWindowSize;
+
+  ProfilerOverlay mProfilerOverlay;
 };
@@ -0,0 +1,98 @@
+#include "ParallaxBackground.hpp"
+#include "../Core/Profiler.hpp"
+#include "../Core/ResourceCache.hpp"
+#include <cmath>
+#include <filesystem>
+
+namespace {
+
+// Span of a layer along one axis: the whole view if it repeats, else just
+// the image. Texture coordinates of a repeating layer are wrapped into the
+// first period so they stay small (and precise) far from the origin.
+void axisSpan(bool repeat, float origin, float imageSize, float scale,
+              float viewStart, float viewSize, float &start, float &end,
+              float &uvStart, float &uvEnd) {
+  if (!repeat) {
+    start = origin;
+    end = origin + imageSize * scale;
+    uvStart = 0.f;
+    uvEnd = imageSize;
+    return;
+  }
+  start = viewStart;
+  end = viewStart + viewSize;
+  uvStart = std::fmod((start - origin) / scale, imageSize);
+  if (uvStart < 0.f)
+    uvStart += imageSize;
+  uvEnd = uvStart + viewSize / scale;
+}
+
+} // namespace
+
+void ParallaxBackground::load(const std::vector<ImageLayer> &layers,
+                              const std::string &directory) {
+  mLayers.clear();
+  mBuilt = false;
+
+  for (const ImageLayer &info : layers) {
+    std::filesystem::path path = std::filesystem::path(directory) / info.source;
+    auto texture = Resources::textures().get(path.lexically_normal().string());
+    if (!texture || texture->getSize().x == 0 || texture->getSize().y == 0)
+      continue; // Already reported by the cache
+    if (info.repeatX || info.repeatY)
+      texture->setRepeated(true);
+
+    Layer &layer = mLayers.emplace_back();
+    layer.info = info;
+    if (layer.info.scale <= 0.f)
+      layer.info.scale = 1.f;
+    layer.texture = std::move(texture);
+  }
+}
+
+void ParallaxBackground::rebuild(Layer &layer) const {
+  const ImageLayer &info = layer.info;
+  sf::Vector2f imageSize(layer.texture->getSize());
+
+  // Tiled's parallax: the layer is shifted by the part of the camera
+  // movement it doesn't follow
+  sf::Vector2f origin(info.offset.x + mViewCenter.x * (1.f - info.parallax.x),
+                      info.offset.y + mViewCenter.y * (1.f - info.parallax.y));
+  sf::Vector2f viewStart = mViewCenter - mViewSize / 2.f;
+
+  float left, right, u0, u1;
+  float top, bottom, v0, v1;
+  axisSpan(info.repeatX, origin.x, imageSize.x, info.scale, viewStart.x,
+           mViewSize.x, left, right, u0, u1);
+  axisSpan(info.repeatY, origin.y, imageSize.y, info.scale, viewStart.y,
+           mViewSize.y, top, bottom, v0, v1);
+
+  sf::VertexArray &quad = layer.quad;
+  quad[0] = {{left, top}, info.tint, {u0, v0}};
+  quad[1] = {{right, top}, info.tint, {u1, v0}};
+  quad[2] = {{left, bottom}, info.tint, {u0, v1}};
+  quad[3] = {{left, bottom}, info.tint, {u0, v1}};
+  quad[4] = {{right, top}, info.tint, {u1, v0}};
+  quad[5] = {{right, bottom}, info.tint, {u1, v1}};
+}
+
+void ParallaxBackground::draw(sf::RenderTarget &target, const sf::View &view) {
+  PROFILE_ZONE("ParallaxBackground::draw");
+  if (mLayers.empty())
+    return;
+
+  if (!mBuilt || view.getCenter() != mViewCenter ||
+      view.getSize() != mViewSize) {
+    mViewCenter = view.getCenter();
+    mViewSize = view.getSize();
+    for (Layer &layer : mLayers)
+      rebuild(layer);
+    mBuilt = true;
+  }
+
+  for (const Layer &layer : mLayers) {
+    sf::RenderStates states;
+    states.texture = layer.texture.get();
+    target.draw(layer.quad, states);
+  }
+}
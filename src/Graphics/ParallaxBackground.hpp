@@ -0,0 +1,51 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// A background image layer, as described by a Tiled <imagelayer>
+struct ImageLayer {
+  std::string name;
+  std::string source;  // Image file, relative to the map file
+  sf::Vector2f offset; // Top-left corner of the image, in pixels
+  // 1 scrolls with the map, 0 stays fixed on screen (per axis)
+  sf::Vector2f parallax{1.f, 1.f};
+  bool repeatX = false;
+  bool repeatY = false;
+  sf::Color tint = sf::Color::White; // Alpha includes the layer opacity
+  float scale = 1.f;                 // "scale" custom property
+};
+
+// Image layers drawn behind the map, in file order (farthest first), each
+// scrolling at its own parallax factor. A layer is a single quad with a
+// repeating texture rather than a grid of tiles, so a level with six
+// layers costs six draw calls. The quads are only rebuilt when the view
+// moves or is resized, and nothing is allocated per frame.
+class ParallaxBackground {
+public:
+  // Loads the layer textures (main thread). directory is the folder of
+  // the map file, which layer sources are relative to.
+  void load(const std::vector<ImageLayer> &layers,
+            const std::string &directory);
+  void clear() { mLayers.clear(); }
+
+  std::size_t getLayerCount() const { return mLayers.size(); }
+
+  // Draws every layer for the given (world) view
+  void draw(sf::RenderTarget &target, const sf::View &view);
+
+private:
+  struct Layer {
+    ImageLayer info;
+    std::shared_ptr<sf::Texture> texture;
+    sf::VertexArray quad{sf::PrimitiveType::Triangles, 6};
+  };
+
+  void rebuild(Layer &layer) const; // For mViewCenter and mViewSize
+
+  std::vector<Layer> mLayers;
+  sf::Vector2f mViewCenter;
+  sf::Vector2f mViewSize;
+  bool mBuilt = false; // Quads match mViewCenter and mViewSize
+};
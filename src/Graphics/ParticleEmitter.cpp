@@ -0,0 +1,204 @@
+#include "ParticleEmitter.hpp"
+#include "../Core/JobSystem.hpp"
+#include "../Core/Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// True if any of the LANES lifetimes starting at life (aligned) ran out
+bool anyExpired(const float *life) {
+#if defined(__AVX__)
+  __m256 expired = _mm256_cmp_ps(_mm256_load_ps(life), _mm256_setzero_ps(),
+                                 _CMP_LE_OQ);
+  return _mm256_movemask_ps(expired) != 0;
+#elif defined(__SSE2__) || defined(_M_X64)
+  __m128 low = _mm_cmple_ps(_mm_load_ps(life), _mm_setzero_ps());
+  __m128 high = _mm_cmple_ps(_mm_load_ps(life + 4), _mm_setzero_ps());
+  return _mm_movemask_ps(_mm_or_ps(low, high)) != 0;
+#else
+  for (int lane = 0; lane < 8; ++lane)
+    if (life[lane] <= 0.f)
+      return true;
+  return false;
+#endif
+}
+
+} // namespace
+
+ParticleEmitter::ParticleEmitter(const ParticleParams &params,
+                                 std::size_t capacity)
+    : mParams(params), mCapacity(capacity) {
+  // Zero-filled padding keeps the SIMD tail lanes harmless
+  const std::size_t padded = (capacity + LANES - 1) / LANES * LANES;
+  mPosX.resize(padded);
+  mPosY.resize(padded);
+  mVelX.resize(padded);
+  mVelY.resize(padded);
+  mLife.resize(padded);
+  mInvLifetime.resize(padded);
+  mColor.resize(padded);
+}
+
+float ParticleEmitter::random() {
+  // xorshift32; the top 24 bits as a float in [0, 1)
+  mSeed ^= mSeed << 13;
+  mSeed ^= mSeed >> 17;
+  mSeed ^= mSeed << 5;
+  return static_cast<float>(mSeed >> 8) * (1.f / 16777216.f);
+}
+
+void ParticleEmitter::emit(sf::Vector2f position, sf::Vector2f direction,
+                           int count) {
+  const float heading = std::atan2(direction.y, direction.x);
+
+  for (int n = 0; n < count && mCount < mCapacity; ++n) {
+    const std::size_t i = mCount++;
+    float angle = heading + (random() * 2.f - 1.f) * mParams.spread;
+    float speed =
+        mParams.speed + (random() * 2.f - 1.f) * mParams.speedVariance;
+    float lifetime = std::max(
+        mParams.lifetime + (random() * 2.f - 1.f) * mParams.lifetimeVariance,
+        0.01f);
+
+    mPosX[i] = position.x;
+    mPosY[i] = position.y;
+    mVelX[i] = std::cos(angle) * speed;
+    mVelY[i] = std::sin(angle) * speed;
+    mLife[i] = lifetime;
+    mInvLifetime[i] = 1.f / lifetime;
+
+    sf::Color color = mParams.color;
+    float shade = 1.f - random() * mParams.colorVariance / 255.f;
+    color.r = static_cast<std::uint8_t>(color.r * shade);
+    color.g = static_cast<std::uint8_t>(color.g * shade);
+    color.b = static_cast<std::uint8_t>(color.b * shade);
+    mColor[i] = color.toInteger();
+  }
+}
+
+void ParticleEmitter::update(float dt) {
+  PROFILE_ZONE("ParticleEmitter::update");
+  integrate(dt);
+  removeExpired();
+}
+
+void ParticleEmitter::integrate(float dt) {
+  // Whole registers up to the last live particle; the columns are padded
+  // so this never runs past them
+  const std::size_t count = (mCount + LANES - 1) / LANES * LANES;
+  const float damping = std::exp(-mParams.drag * dt);
+  const float fall = mParams.gravity * dt;
+
+  float *posX = mPosX.data();
+  float *posY = mPosY.data();
+  float *velX = mVelX.data();
+  float *velY = mVelY.data();
+  float *life = mLife.data();
+
+#if defined(__AVX__)
+  const __m256 step = _mm256_set1_ps(dt);
+  const __m256 damp = _mm256_set1_ps(damping);
+  const __m256 gravity = _mm256_set1_ps(fall);
+  for (std::size_t i = 0; i < count; i += 8) {
+    __m256 vx = _mm256_mul_ps(_mm256_load_ps(velX + i), damp);
+    __m256 vy = _mm256_add_ps(_mm256_mul_ps(_mm256_load_ps(velY + i), damp),
+                              gravity);
+    _mm256_store_ps(velX + i, vx);
+    _mm256_store_ps(velY + i, vy);
+    _mm256_store_ps(posX + i, _mm256_add_ps(_mm256_load_ps(posX + i),
+                                            _mm256_mul_ps(vx, step)));
+    _mm256_store_ps(posY + i, _mm256_add_ps(_mm256_load_ps(posY + i),
+                                            _mm256_mul_ps(vy, step)));
+    _mm256_store_ps(life + i, _mm256_sub_ps(_mm256_load_ps(life + i), step));
+  }
+#elif defined(__SSE2__) || defined(_M_X64)
+  const __m128 step = _mm_set1_ps(dt);
+  const __m128 damp = _mm_set1_ps(damping);
+  const __m128 gravity = _mm_set1_ps(fall);
+  for (std::size_t i = 0; i < count; i += 4) {
+    __m128 vx = _mm_mul_ps(_mm_load_ps(velX + i), damp);
+    __m128 vy =
+        _mm_add_ps(_mm_mul_ps(_mm_load_ps(velY + i), damp), gravity);
+    _mm_store_ps(velX + i, vx);
+    _mm_store_ps(velY + i, vy);
+    _mm_store_ps(posX + i,
+                 _mm_add_ps(_mm_load_ps(posX + i), _mm_mul_ps(vx, step)));
+    _mm_store_ps(posY + i,
+                 _mm_add_ps(_mm_load_ps(posY + i), _mm_mul_ps(vy, step)));
+    _mm_store_ps(life + i, _mm_sub_ps(_mm_load_ps(life + i), step));
+  }
+#else
+  for (std::size_t i = 0; i < count; ++i) {
+    velX[i] *= damping;
+    velY[i] = velY[i] * damping + fall;
+    posX[i] += velX[i] * dt;
+    posY[i] += velY[i] * dt;
+    life[i] -= dt;
+  }
+#endif
+}
+
+void ParticleEmitter::removeExpired() {
+  std::size_t i = 0;
+  while (i < mCount) {
+    // Most registers hold no expired particle; skip them whole
+    if (i % LANES == 0 && i + LANES <= mCount && !anyExpired(&mLife[i])) {
+      i += LANES;
+      continue;
+    }
+    if (mLife[i] > 0.f) {
+      ++i;
+      continue;
+    }
+
+    // Move the last particle into the hole (and look at it again)
+    const std::size_t last = --mCount;
+    mPosX[i] = mPosX[last];
+    mPosY[i] = mPosY[last];
+    mVelX[i] = mVelX[last];
+    mVelY[i] = mVelY[last];
+    mLife[i] = mLife[last];
+    mInvLifetime[i] = mInvLifetime[last];
+    mColor[i] = mColor[last];
+  }
+}
+
+void ParticleEmitter::buildVertices(sf::VertexArray &out) const {
+  PROFILE_ZONE("ParticleEmitter::buildVertices");
+  out.resize(mCount * 6);
+  const float half = mParams.size * 0.5f;
+
+  JobSystem::instance().parallelForWait(
+      mCount, BATCH_SIZE, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+          sf::Color color(mColor[i]);
+          float fade = std::clamp(mLife[i] * mInvLifetime[i], 0.f, 1.f);
+          color.a = static_cast<std::uint8_t>(color.a * fade);
+
+          const float left = mPosX[i] - half;
+          const float top = mPosY[i] - half;
+          const float right = mPosX[i] + half;
+          const float bottom = mPosY[i] + half;
+
+          sf::Vertex *quad = &out[i * 6];
+          quad[0] = {{left, top}, color};
+          quad[1] = {{right, top}, color};
+          quad[2] = {{left, bottom}, color};
+          quad[3] = {{left, bottom}, color};
+          quad[4] = {{right, top}, color};
+          quad[5] = {{right, bottom}, color};
+        }
+      });
+}
+
+void ParticleEmitter::draw(sf::RenderTarget &target) {
+  if (mCount == 0)
+    return;
+  buildVertices(mVertices);
+  target.draw(mVertices);
+}
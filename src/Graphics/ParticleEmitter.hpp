@@ -0,0 +1,95 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// How the particles of one emitter look and move
+struct ParticleParams {
+  float lifetime = 0.5f; // Seconds, varied by up to +-lifetimeVariance
+  float lifetimeVariance = 0.f;
+  float speed = 100.f; // Pixels per second, varied by up to +-speedVariance
+  float speedVariance = 0.f;
+  float spread = 3.14159265f; // Radians either side of the emit direction
+  float gravity = 0.f;        // Pixels per second squared, downwards
+  float drag = 0.f;           // Velocity decay rate, per second
+  float size = 2.f;           // Side of the square, in pixels
+  sf::Color color = sf::Color::White;
+  std::uint8_t colorVariance = 0; // Random darkening per particle
+};
+
+// A pool of short-lived untextured particles sharing one ParticleParams,
+// for effects like landing dust or wall-slide sparks.
+//
+// Particles are stored as structure-of-arrays, one aligned column per
+// component, padded to a whole number of SIMD registers so update() can
+// run over them eight (AVX) or four (SSE2) at a time without a scalar
+// tail. Dead particles are swapped out with the last live one. Storage is
+// allocated up front for the capacity; emitting beyond it is dropped.
+//
+// Purely visual: particles live on the render side, step with the frame
+// time and never feed back into the simulation.
+class ParticleEmitter {
+public:
+  explicit ParticleEmitter(const ParticleParams &params,
+                           std::size_t capacity = 16384);
+
+  // Spawns count particles at position, heading around direction (need
+  // not be normalized)
+  void emit(sf::Vector2f position, sf::Vector2f direction, int count);
+
+  // Moves every particle by dt seconds and removes the expired ones
+  void update(float dt);
+
+  void clear() { mCount = 0; }
+  std::size_t size() const { return mCount; }
+  std::size_t capacity() const { return mCapacity; }
+
+  // Fills the vertex array with two triangles per particle, faded by
+  // remaining lifetime (large emitters are built in parallel batches)
+  void buildVertices(sf::VertexArray &out) const;
+
+  // Builds into the emitter's own array and draws it in one call
+  void draw(sf::RenderTarget &target);
+
+private:
+  static constexpr std::size_t LANES = 8; // Widest SIMD register (AVX)
+  static constexpr std::size_t ALIGNMENT = 64;
+  static constexpr std::size_t BATCH_SIZE = 8192; // Vertex building
+
+  template <typename T> struct AlignedAllocator {
+    using value_type = T;
+    AlignedAllocator() = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U> &) {}
+    T *allocate(std::size_t n) {
+      return static_cast<T *>(
+          ::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT)));
+    }
+    void deallocate(T *p, std::size_t) {
+      ::operator delete(p, std::align_val_t(ALIGNMENT));
+    }
+    template <typename U> bool operator==(const AlignedAllocator<U> &) const {
+      return true;
+    }
+  };
+  template <typename T> using Column = std::vector<T, AlignedAllocator<T>>;
+
+  void integrate(float dt); // SIMD kernel over every column
+  void removeExpired();
+  float random(); // 0..1
+
+  ParticleParams mParams;
+  std::size_t mCapacity;
+  std::size_t mCount = 0;
+  std::uint32_t mSeed = 0x9E3779B9u;
+
+  // Components, each sized to the padded capacity
+  Column<float> mPosX, mPosY;
+  Column<float> mVelX, mVelY;
+  Column<float> mLife;         // Seconds left
+  Column<float> mInvLifetime;  // 1 / initial lifetime, for fading
+  Column<std::uint32_t> mColor; // Packed RGBA
+
+  sf::VertexArray mVertices{sf::PrimitiveType::Triangles};
+};
@@ -0,0 +1,102 @@
+#include "ProfilerOverlay.hpp"
+#include "../Core/Profiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+constexpr size_t GRAPH_FRAMES = 240; // Profiler frame history
+constexpr float GRAPH_WIDTH = 240.f;
+constexpr float GRAPH_HEIGHT = 60.f;
+constexpr float GRAPH_MAX_MS = 33.3f; // Top of the graph (two 60 Hz frames)
+constexpr float FRAME_BUDGET_MS = 1000.f / 60.f;
+
+void appendQuad(sf::VertexArray &vertices, sf::FloatRect rect,
+                sf::Color color) {
+  sf::Vector2f topLeft = rect.position;
+  sf::Vector2f bottomRight = rect.position + rect.size;
+  vertices.append({topLeft, color});
+  vertices.append({{bottomRight.x, topLeft.y}, color});
+  vertices.append({{topLeft.x, bottomRight.y}, color});
+  vertices.append({{topLeft.x, bottomRight.y}, color});
+  vertices.append({{bottomRight.x, topLeft.y}, color});
+  vertices.append({bottomRight, color});
+}
+
+} // namespace
+
+void ProfilerOverlay::setFont(const sf::Font &font) {
+  mGlyphs.emplace(font, 12, 1.f);
+  mHasRefreshed = false;
+}
+
+void ProfilerOverlay::refreshText() {
+  if (!mGlyphs)
+    return;
+
+  std::vector<float> sorted = mFrameTimes;
+  std::sort(sorted.begin(), sorted.end());
+  float average = 0.f;
+  for (float ms : sorted)
+    average += ms;
+  average = sorted.empty() ? 0.f : average / sorted.size();
+  float p99 = sorted.empty() ? 0.f : sorted[(sorted.size() - 1) * 99 / 100];
+
+  char line[128];
+  std::snprintf(line, sizeof(line), "frame  avg %.2f ms  p99 %.2f ms\n",
+                average, p99);
+  std::string &text = mTextBuffer;
+  text = line;
+
+  if (!Profiler::ENABLED) {
+    text += "zones compiled out (JTC_PROFILER=OFF)";
+  } else {
+    text += "zone              calls    avg ms    p99 ms\n";
+    for (const auto &zone : Profiler::collectStats(120)) {
+      std::snprintf(line, sizeof(line), "%-16.16s %6u %9.3f %9.3f\n",
+                    zone.name.c_str(), zone.count, zone.averageMs,
+                    zone.p99Ms);
+      text += line;
+    }
+  }
+  mText.clear();
+  mText.append(*mGlyphs, text, {10.f, GRAPH_HEIGHT + 20.f});
+}
+
+void ProfilerOverlay::draw(sf::RenderTarget &target) {
+  Profiler::getFrameTimes(mFrameTimes);
+
+  if (!mHasRefreshed || mRefreshClock.getElapsedTime().asSeconds() >= 0.25f) {
+    refreshText();
+    mRefreshClock.restart();
+    mHasRefreshed = true;
+  }
+
+  // Frame time graph: one bar per frame, newest on the right, with a line
+  // at the 60 Hz budget
+  sf::Vector2f origin(10.f, 10.f);
+  mGraph.clear();
+  appendQuad(mGraph, {origin, {GRAPH_WIDTH, GRAPH_HEIGHT}},
+             sf::Color(0, 0, 0, 160));
+
+  float barWidth = GRAPH_WIDTH / GRAPH_FRAMES;
+  float x = origin.x + GRAPH_WIDTH - barWidth * mFrameTimes.size();
+  for (float ms : mFrameTimes) {
+    float height = std::min(ms / GRAPH_MAX_MS, 1.f) * GRAPH_HEIGHT;
+    sf::Color color = ms <= FRAME_BUDGET_MS * 1.05f ? sf::Color::Green
+                      : ms <= GRAPH_MAX_MS          ? sf::Color::Yellow
+                                                    : sf::Color::Red;
+    appendQuad(mGraph,
+               {{x, origin.y + GRAPH_HEIGHT - height}, {barWidth, height}},
+               color);
+    x += barWidth;
+  }
+
+  float budgetY =
+      origin.y + GRAPH_HEIGHT - FRAME_BUDGET_MS / GRAPH_MAX_MS * GRAPH_HEIGHT;
+  appendQuad(mGraph, {{origin.x, budgetY}, {GRAPH_WIDTH, 1.f}},
+             sf::Color(255, 255, 255, 128));
+
+  target.draw(mGraph);
+  mText.draw(target);
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "TextLayout.hpp"
+#include <SFML/Graphics.hpp>
+#include <optional>
+#include <string>
+#include <vector>
+
+// F3 overlay: a graph of recent frame times and a table of per-zone
+// average and p99 timings from the profiler. The table is refreshed a few
+// times per second rather than every frame, so it costs little to keep on.
+class ProfilerOverlay {
+public:
+  void setFont(const sf::Font &font);
+
+  // Draws in the target's default view (top-left corner)
+  void draw(sf::RenderTarget &target);
+
+private:
+  void refreshText();
+
+  std::optional<GlyphCache> mGlyphs;
+  TextBatch mText;
+  std::string mTextBuffer; // Reused between refreshes
+  sf::Clock mRefreshClock;
+  bool mHasRefreshed = false;
+
+  std::vector<float> mFrameTimes;
+  sf::VertexArray mGraph{sf::PrimitiveType::Triangles};
+};
@@ -0,0 +1,228 @@
+#include "TextLayout.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Next code point of UTF-8 text. A byte that doesn't start a valid
+// sequence is taken as Latin-1.
+char32_t decodeUTF8(std::string_view text, std::size_t &i) {
+  const unsigned char lead = static_cast<unsigned char>(text[i++]);
+  if (lead < 0xC2 || lead >= 0xF8)
+    return lead;
+
+  const std::size_t extra = lead >= 0xF0 ? 3 : lead >= 0xE0 ? 2 : 1;
+  if (i + extra > text.size())
+    return lead;
+
+  char32_t codepoint = lead & (0x3F >> extra);
+  for (std::size_t k = 0; k < extra; ++k) {
+    const unsigned char next = static_cast<unsigned char>(text[i + k]);
+    if ((next & 0xC0) != 0x80)
+      return lead;
+    codepoint = (codepoint << 6) | (next & 0x3F);
+  }
+  i += extra;
+  return codepoint;
+}
+
+// Two triangles for a glyph, padded by a texel like sf::Text does so
+// smoothed edges aren't cut off
+void appendQuad(sf::VertexArray &vertices, sf::Vector2f pen,
+                const sf::FloatRect &bounds, const sf::IntRect &rect,
+                sf::Color color) {
+  constexpr float padding = 1.f;
+  const float left = pen.x + bounds.position.x - padding;
+  const float top = pen.y + bounds.position.y - padding;
+  const float right = pen.x + bounds.position.x + bounds.size.x + padding;
+  const float bottom = pen.y + bounds.position.y + bounds.size.y + padding;
+
+  const float u1 = static_cast<float>(rect.position.x) - padding;
+  const float v1 = static_cast<float>(rect.position.y) - padding;
+  const float u2 = static_cast<float>(rect.position.x + rect.size.x) + padding;
+  const float v2 = static_cast<float>(rect.position.y + rect.size.y) + padding;
+
+  vertices.append({{left, top}, color, {u1, v1}});
+  vertices.append({{right, top}, color, {u2, v1}});
+  vertices.append({{left, bottom}, color, {u1, v2}});
+  vertices.append({{left, bottom}, color, {u1, v2}});
+  vertices.append({{right, top}, color, {u2, v1}});
+  vertices.append({{right, bottom}, color, {u2, v2}});
+}
+
+} // namespace
+
+GlyphCache::GlyphCache(const sf::Font &font, unsigned characterSize,
+                       float outlineThickness)
+    : mFont(&font), mCharacterSize(characterSize),
+      mOutlineThickness(outlineThickness),
+      mLineSpacing(font.getLineSpacing(characterSize)),
+      mKerning(TABLE_SIZE * TABLE_SIZE,
+               std::numeric_limits<float>::quiet_NaN()) {}
+
+GlyphCache::Glyph GlyphCache::load(char32_t codepoint) const {
+  Glyph glyph;
+  const sf::Glyph &fill = mFont->getGlyph(codepoint, mCharacterSize, false);
+  glyph.advance = fill.advance;
+  glyph.bounds = fill.bounds;
+  glyph.textureRect = fill.textureRect;
+  if (mOutlineThickness != 0.f) {
+    const sf::Glyph &outline =
+        mFont->getGlyph(codepoint, mCharacterSize, false, mOutlineThickness);
+    glyph.outlineBounds = outline.bounds;
+    glyph.outlineRect = outline.textureRect;
+  }
+  return glyph;
+}
+
+const GlyphCache::Glyph &GlyphCache::get(char32_t codepoint) {
+  if (codepoint < TABLE_SIZE) {
+    if (!mLoaded[codepoint]) {
+      mTable[codepoint] = load(codepoint);
+      mLoaded[codepoint] = true;
+    }
+    return mTable[codepoint];
+  }
+
+  auto it = mOther.find(codepoint);
+  if (it == mOther.end())
+    it = mOther.emplace(codepoint, load(codepoint)).first;
+  return it->second;
+}
+
+float GlyphCache::getKerning(char32_t first, char32_t second) {
+  if (first >= TABLE_SIZE || second >= TABLE_SIZE)
+    return mFont->getKerning(first, second, mCharacterSize);
+
+  float &kerning = mKerning[first * TABLE_SIZE + second];
+  if (kerning != kerning) // NaN: not looked up yet
+    kerning = mFont->getKerning(first, second, mCharacterSize);
+  return kerning;
+}
+
+template <typename Emit>
+sf::Vector2f TextBatch::layout(GlyphCache &glyphs, std::string_view text,
+                               float maxWidth, Emit &&emit) {
+  const float spaceAdvance = glyphs.get(U' ').advance;
+  const float lineSpacing = glyphs.getLineSpacing();
+
+  // Glyphs are collected per word; a word is placed once its end is
+  // reached, on the current line or, if it doesn't fit there, the next
+  float baseline = static_cast<float>(glyphs.getCharacterSize());
+  float lineWidth = 0.f;    // End of the last word on the line
+  float pendingSpace = 0.f; // Whitespace since then
+  bool lineHasWords = false;
+  float wordWidth = 0.f;
+  char32_t previous = 0; // For kerning within the word
+  float width = 0.f;
+  int lines = 1;
+
+  auto placeWord = [&] {
+    if (mWord.empty())
+      return;
+    float x = lineWidth + pendingSpace;
+    if (maxWidth > 0.f && lineHasWords && x + wordWidth > maxWidth) {
+      baseline += lineSpacing;
+      ++lines;
+      x = 0.f; // The spaces before a wrapped word are dropped
+    }
+    for (const PlacedGlyph &placed : mWord)
+      emit(*placed.glyph, sf::Vector2f(x + placed.x, baseline));
+
+    lineWidth = x + wordWidth;
+    lineHasWords = true;
+    width = std::max(width, lineWidth);
+    pendingSpace = 0.f;
+    mWord.clear();
+    wordWidth = 0.f;
+  };
+
+  std::size_t i = 0;
+  while (i < text.size()) {
+    const char32_t c = decodeUTF8(text, i);
+    switch (c) {
+    case U' ':
+    case U'\t':
+    case U'\n':
+      placeWord();
+      previous = 0;
+      if (c == U'\n') {
+        baseline += lineSpacing;
+        ++lines;
+        lineWidth = 0.f;
+        pendingSpace = 0.f;
+        lineHasWords = false;
+      } else {
+        pendingSpace += c == U'\t' ? spaceAdvance * 4.f : spaceAdvance;
+      }
+      continue;
+    case U'\r':
+      continue;
+    default:
+      break;
+    }
+
+    if (previous != 0)
+      wordWidth += glyphs.getKerning(previous, c);
+    const GlyphCache::Glyph &glyph = glyphs.get(c);
+    mWord.push_back({&glyph, wordWidth});
+    wordWidth += glyph.advance;
+    previous = c;
+  }
+  placeWord();
+
+  return {width, lines * lineSpacing};
+}
+
+void TextBatch::clear() {
+  mOutlines.clear();
+  mFills.clear();
+}
+
+sf::Vector2f TextBatch::append(GlyphCache &glyphs, std::string_view text,
+                               sf::Vector2f position, sf::Color fill,
+                               sf::Color outline, float maxWidth) {
+  const bool outlined = glyphs.getOutlineThickness() != 0.f;
+  sf::Vector2f size =
+      layout(glyphs, text, maxWidth,
+             [&](const GlyphCache::Glyph &glyph, sf::Vector2f pen) {
+               if (glyph.textureRect.size.x <= 0)
+                 return; // Nothing to draw (e.g. a missing glyph)
+               pen += position;
+               if (outlined) {
+                 appendQuad(mOutlines, pen, glyph.outlineBounds,
+                            glyph.outlineRect, outline);
+               }
+               appendQuad(mFills, pen, glyph.bounds, glyph.textureRect, fill);
+             });
+
+  // Taken after layout: new glyphs may have resized the texture
+  mTexture = &glyphs.getTexture();
+  return size;
+}
+
+void TextBatch::append(const TextBatch &other) {
+  if (other.empty())
+    return;
+  for (std::size_t i = 0; i < other.mOutlines.getVertexCount(); ++i)
+    mOutlines.append(other.mOutlines[i]);
+  for (std::size_t i = 0; i < other.mFills.getVertexCount(); ++i)
+    mFills.append(other.mFills[i]);
+  mTexture = other.mTexture;
+}
+
+sf::Vector2f TextBatch::measure(GlyphCache &glyphs, std::string_view text,
+                                float maxWidth) {
+  return layout(glyphs, text, maxWidth,
+                [](const GlyphCache::Glyph &, sf::Vector2f) {});
+}
+
+void TextBatch::draw(sf::RenderTarget &target,
+                     sf::RenderStates states) const {
+  if (empty())
+    return;
+  states.texture = mTexture;
+  if (mOutlines.getVertexCount() > 0)
+    target.draw(mOutlines, states);
+  target.draw(mFills, states);
+}
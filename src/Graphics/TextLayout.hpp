@@ -0,0 +1,99 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Metrics of one font at one character size and outline thickness, asked
+// from the font once per character instead of on every layout. ASCII
+// glyphs and kerning pairs live in flat tables, anything else in a map.
+// Looking up a new glyph may add it to the font texture, so use a cache
+// from the main thread only. The font must outlive it.
+class GlyphCache {
+public:
+  struct Glyph {
+    float advance = 0.f;
+    sf::FloatRect bounds; // Relative to the pen position on the baseline
+    sf::IntRect textureRect;
+    sf::FloatRect outlineBounds; // Same for the outline (if any)
+    sf::IntRect outlineRect;
+  };
+
+  GlyphCache(const sf::Font &font, unsigned characterSize,
+             float outlineThickness = 0.f);
+
+  const Glyph &get(char32_t codepoint);
+  float getKerning(char32_t first, char32_t second);
+
+  unsigned getCharacterSize() const { return mCharacterSize; }
+  float getOutlineThickness() const { return mOutlineThickness; }
+  float getLineSpacing() const { return mLineSpacing; }
+  const sf::Texture &getTexture() const {
+    return mFont->getTexture(mCharacterSize);
+  }
+
+private:
+  static constexpr char32_t TABLE_SIZE = 128;
+
+  Glyph load(char32_t codepoint) const;
+
+  const sf::Font *mFont;
+  unsigned mCharacterSize;
+  float mOutlineThickness;
+  float mLineSpacing;
+
+  std::array<Glyph, TABLE_SIZE> mTable;
+  std::array<bool, TABLE_SIZE> mLoaded{};
+  std::vector<float> mKerning; // TABLE_SIZE^2, NaN until looked up
+  std::unordered_map<char32_t, Glyph> mOther;
+};
+
+// Any number of strings laid out into one vertex array and drawn in one
+// go, outlines under fills. Callers rebuild it only when the text
+// changes; clearing keeps the storage. Text is UTF-8. All strings in a
+// batch share one texture, so their caches must use the same font and
+// character size.
+class TextBatch {
+public:
+  void clear();
+  bool empty() const { return mFills.getVertexCount() == 0; }
+
+  // Lays out text with its top-left corner at position, like an sf::Text
+  // placed there. With a maxWidth, lines wrap at spaces so that they fit
+  // (a single word longer than that keeps its own line). Returns the
+  // size of the laid out text.
+  sf::Vector2f append(GlyphCache &glyphs, std::string_view text,
+                      sf::Vector2f position,
+                      sf::Color fill = sf::Color::White,
+                      sf::Color outline = sf::Color::Black,
+                      float maxWidth = 0.f);
+
+  // Adds the vertices of another batch laid out with the same font and
+  // character size, e.g. to draw a subset of prepared strings in one go
+  void append(const TextBatch &other);
+
+  // Size append() would return, without building any vertices
+  sf::Vector2f measure(GlyphCache &glyphs, std::string_view text,
+                       float maxWidth = 0.f);
+
+  void draw(sf::RenderTarget &target,
+            sf::RenderStates states = sf::RenderStates::Default) const;
+
+private:
+  struct PlacedGlyph {
+    const GlyphCache::Glyph *glyph;
+    float x; // Pen position within its word
+  };
+
+  // One pass over the text: calls emit(glyph, penPosition) for every
+  // visible glyph, with the pen relative to the top-left corner
+  template <typename Emit>
+  sf::Vector2f layout(GlyphCache &glyphs, std::string_view text,
+                      float maxWidth, Emit &&emit);
+
+  const sf::Texture *mTexture = nullptr;
+  sf::VertexArray mOutlines{sf::PrimitiveType::Triangles};
+  sf::VertexArray mFills{sf::PrimitiveType::Triangles};
+  std::vector<PlacedGlyph> mWord; // Scratch for the word being laid out
+};
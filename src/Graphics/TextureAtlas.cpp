@@ -0,0 +1,165 @@
+#include "TextureAtlas.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+struct Placement {
+  size_t page = 0;
+  sf::Vector2u position;
+};
+
+// Shelf packing: images sorted by height fill rows left to right, a new row
+// starts below the tallest image of the previous one, and a new page starts
+// when a row no longer fits. Returns the number of pages used.
+size_t packShelves(const std::vector<sf::Vector2u> &sizes,
+                   const std::vector<size_t> &order, unsigned int pageSize,
+                   std::vector<Placement> &placements) {
+  size_t page = 0;
+  unsigned int x = 0;
+  unsigned int y = 0;
+  unsigned int shelfHeight = 0;
+
+  for (size_t index : order) {
+    sf::Vector2u size = sizes[index];
+    if (x + size.x > pageSize) {
+      x = 0;
+      y += shelfHeight;
+      shelfHeight = 0;
+    }
+    if (y + size.y > pageSize) {
+      ++page;
+      x = 0;
+      y = 0;
+      shelfHeight = 0;
+    }
+    placements[index] = {page, {x, y}};
+    x += size.x;
+    shelfHeight = std::max(shelfHeight, size.y);
+  }
+  return order.empty() ? 0 : page + 1;
+}
+
+// Copies image into page at position, then repeats its outermost rows and
+// columns into the padding ring around it
+bool blit(sf::Image &page, const sf::Image &image, sf::Vector2u position,
+          unsigned int padding) {
+  sf::Vector2u size = image.getSize();
+  int w = static_cast<int>(size.x);
+  int h = static_cast<int>(size.y);
+  bool ok = page.copy(image, position);
+
+  for (unsigned int p = 1; p <= padding; ++p) {
+    ok &= page.copy(image, {position.x, position.y - p},
+                    sf::IntRect({0, 0}, {w, 1}));
+    ok &= page.copy(image, {position.x, position.y + size.y + p - 1},
+                    sf::IntRect({0, h - 1}, {w, 1}));
+    ok &= page.copy(image, {position.x - p, position.y},
+                    sf::IntRect({0, 0}, {1, h}));
+    ok &= page.copy(image, {position.x + size.x + p - 1, position.y},
+                    sf::IntRect({w - 1, 0}, {1, h}));
+  }
+  return ok;
+}
+
+} // namespace
+
+bool TextureAtlas::addImage(const std::string &name, const std::string &path) {
+  sf::Image image;
+  if (!image.loadFromFile(path)) {
+    std::cerr << "Failed to load " << path << std::endl;
+    return false;
+  }
+  addImage(name, std::move(image));
+  return true;
+}
+
+void TextureAtlas::addImage(const std::string &name, sf::Image image) {
+  mPending.push_back({name, std::move(image)});
+}
+
+bool TextureAtlas::build(unsigned int maxPageSize) {
+  if (maxPageSize == 0)
+    maxPageSize = sf::Texture::getMaximumSize();
+
+  // Padded sizes; anything larger than a page can't be packed
+  std::vector<sf::Vector2u> sizes;
+  std::vector<size_t> order;
+  unsigned long long area = 0;
+  for (size_t i = 0; i < mPending.size(); ++i) {
+    sf::Vector2u size = mPending[i].image.getSize();
+    size.x += 2 * PADDING;
+    size.y += 2 * PADDING;
+    sizes.push_back(size);
+    if (size.x > maxPageSize || size.y > maxPageSize) {
+      std::cerr << "Atlas image too large: " << mPending[i].name << std::endl;
+      continue;
+    }
+    order.push_back(i);
+    area += static_cast<unsigned long long>(size.x) * size.y;
+  }
+
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return sizes[a].y > sizes[b].y;
+  });
+
+  // Smallest power-of-two page that holds everything, else several full
+  // sized pages
+  unsigned int pageSize = 64;
+  while (pageSize < maxPageSize &&
+         static_cast<unsigned long long>(pageSize) * pageSize < area)
+    pageSize *= 2;
+  std::vector<Placement> placements(mPending.size());
+  size_t pageCount = packShelves(sizes, order, pageSize, placements);
+  while (pageCount > 1 && pageSize < maxPageSize) {
+    pageSize = std::min(pageSize * 2, maxPageSize);
+    pageCount = packShelves(sizes, order, pageSize, placements);
+  }
+
+  // Compose the pages on the CPU and upload each one once
+  std::vector<sf::Image> images(pageCount,
+                                sf::Image({pageSize, pageSize},
+                                          sf::Color::Transparent));
+  bool ok = order.size() == mPending.size();
+  for (size_t index : order) {
+    const Placement &placement = placements[index];
+    sf::Vector2u position(placement.position.x + PADDING,
+                          placement.position.y + PADDING);
+    ok &= blit(images[placement.page], mPending[index].image, position,
+               PADDING);
+  }
+
+  size_t firstPage = mPages.size();
+  for (const sf::Image &image : images) {
+    auto texture = std::make_unique<sf::Texture>();
+    if (!texture->loadFromImage(image)) {
+      std::cerr << "Failed to upload atlas page" << std::endl;
+      ok = false;
+    }
+    mPages.push_back(std::move(texture));
+  }
+
+  for (size_t index : order) {
+    const Placement &placement = placements[index];
+    sf::Vector2u size = mPending[index].image.getSize();
+    Region region;
+    region.texture = mPages[firstPage + placement.page].get();
+    region.rect = sf::IntRect(
+        {static_cast<int>(placement.position.x + PADDING),
+         static_cast<int>(placement.position.y + PADDING)},
+        {static_cast<int>(size.x), static_cast<int>(size.y)});
+    mRegions[mPending[index].name] = region;
+  }
+
+  std::cout << "Packed " << order.size() << " images into " << pageCount
+            << " atlas page(s) of " << pageSize << "x" << pageSize
+            << std::endl;
+  mPending.clear();
+  return ok;
+}
+
+const TextureAtlas::Region *
+TextureAtlas::find(const std::string &name) const {
+  auto it = mRegions.find(name);
+  return it != mRegions.end() ? &it->second : nullptr;
+}
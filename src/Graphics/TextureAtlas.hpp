@@ -0,0 +1,46 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Packs many small images into as few textures as possible at startup.
+// Drawing everything from one page lets consecutive draws share a single
+// texture bind. Images are added by name, packed with build(), and then
+// looked up as (page texture, pixel rect) regions.
+class TextureAtlas {
+public:
+  struct Region {
+    const sf::Texture *texture = nullptr;
+    sf::IntRect rect;
+  };
+
+  // Queues an image file for packing; false if it can't be read
+  bool addImage(const std::string &name, const std::string &path);
+  void addImage(const std::string &name, sf::Image image);
+
+  // Packs every queued image and uploads the pages.
+  // Pages are square powers of two, at most maxPageSize (0 = GPU limit).
+  bool build(unsigned int maxPageSize = 0);
+
+  // Region of a packed image, or nullptr if there is none by that name
+  const Region *find(const std::string &name) const;
+
+  size_t getPageCount() const { return mPages.size(); }
+  const sf::Texture &getPage(size_t index) const { return *mPages[index]; }
+
+private:
+  struct Pending {
+    std::string name;
+    sf::Image image;
+  };
+
+  // Empty pixels around each image; the border is filled with the image's
+  // edge so filtering or rounding never samples a neighbour
+  static constexpr unsigned int PADDING = 1;
+
+  std::vector<Pending> mPending;
+  std::vector<std::unique_ptr<sf::Texture>> mPages; // Stable addresses
+  std::unordered_map<std::string, Region> mRegions;
+};
@@ -0,0 +1,249 @@
+#include "ChunkStreamer.hpp"
+#include "../Core/MappedFile.hpp"
+#include "../Core/Profiler.hpp"
+#include "Map.hpp"
+#include "TileRenderer.hpp"
+#include <algorithm>
+#include <cmath>
+
+ChunkStreamer::ChunkStreamer(int chunksX, int chunksY,
+                             std::vector<Source> sources,
+                             std::string_view mainEncoding,
+                             std::string_view texturesEncoding,
+                             const TileTypes &types,
+                             const StreamSettings &settings)
+    : mChunksX(chunksX), mChunksY(chunksY), mSources(std::move(sources)),
+      mMainEncoding(mainEncoding), mTexturesEncoding(texturesEncoding),
+      mTypes(types), mSettings(settings) {
+  mSlotOf.assign(mSources.size(), -1);
+  mCellState.assign(mSources.size(), CellState::Unloaded);
+
+  // Budget each slot for its worst case, a mesh with every tile drawn
+  size_t slotBytes = sizeof(Slot) + TILES * 6 * sizeof(sf::Vertex);
+  size_t slotCount = std::min(mSettings.memoryBudget / slotBytes,
+                              mSources.size());
+  mSlots.resize(std::max<size_t>(slotCount, 1));
+  for (size_t i = mSlots.size(); i-- > 0;)
+    mFreeSlots.push_back(static_cast<std::int32_t>(i));
+}
+
+ChunkStreamer::~ChunkStreamer() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mWake.notify_all();
+  if (mWorker.joinable())
+    mWorker.join();
+}
+
+void ChunkStreamer::setContent(std::unique_ptr<MappedFile> file) {
+  mFile = std::move(file);
+  mContent = mFile->view();
+}
+
+void ChunkStreamer::setContent(std::string content) {
+  mOwnedContent = std::move(content);
+  mContent = mOwnedContent;
+}
+
+void ChunkStreamer::setTileset(std::vector<sf::IntRect> tileRects,
+                               float tileSize) {
+  mTileRects = std::move(tileRects);
+  mTileSize = tileSize;
+}
+
+void ChunkStreamer::update(const sf::FloatRect &area, TileRenderer &renderer,
+                           bool wait) {
+  PROFILE_ZONE("ChunkStreamer::update");
+  wait |= mSettings.synchronous;
+
+  // Collect what the worker finished, and take back the requests it
+  // hasn't started: they are issued again below, in the new order
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mFinished.insert(mFinished.end(), mDone.begin(), mDone.end());
+    mDone.clear();
+    for (std::int32_t slot : mRequests) {
+      mCellState[mSlots[slot].cell] = CellState::Unloaded;
+      mSlots[slot].cell = -1;
+      mFreeSlots.push_back(slot);
+    }
+    mRequests.clear();
+  }
+
+  // Meshes change under the renderer's lock. If a frame is being drawn,
+  // installing and unloading wait for the next update rather than stall.
+  std::unique_lock<std::shared_mutex> meshes(mMeshMutex, std::defer_lock);
+  if (wait)
+    meshes.lock();
+  else
+    meshes.try_lock();
+
+  if (meshes.owns_lock()) {
+    for (std::int32_t slot : mFinished)
+      install(slot, renderer);
+    mFinished.clear();
+  }
+
+  // Wanted: the chunks under the area, plus the radius on every side
+  float chunkPixels = CHUNK_SIZE * mTileSize;
+  int radius = std::max(mSettings.radius, 0);
+  int left = std::max(
+      static_cast<int>(std::floor(area.position.x / chunkPixels)) - radius, 0);
+  int top = std::max(
+      static_cast<int>(std::floor(area.position.y / chunkPixels)) - radius, 0);
+  int right = std::min(static_cast<int>(std::floor(
+                           (area.position.x + area.size.x) / chunkPixels)) +
+                           radius,
+                       mChunksX - 1);
+  int bottom = std::min(static_cast<int>(std::floor(
+                            (area.position.y + area.size.y) / chunkPixels)) +
+                            radius,
+                        mChunksY - 1);
+  sf::Vector2f center = area.getCenter() / chunkPixels;
+  auto distance = [&](std::int32_t cell) {
+    float dx = cell % mChunksX + 0.5f - center.x;
+    float dy = cell / mChunksX + 0.5f - center.y;
+    return dx * dx + dy * dy;
+  };
+  auto byDistance = [&](std::int32_t a, std::int32_t b) {
+    return distance(a) < distance(b);
+  };
+
+  // Missing chunks, nearest first (chunks absent from the file are empty
+  // and never need loading)
+  mMissing.clear();
+  for (int y = top; y <= bottom; ++y) {
+    for (int x = left; x <= right; ++x) {
+      std::int32_t cell = y * mChunksX + x;
+      const Source &source = mSources[cell];
+      if (mCellState[cell] == CellState::Unloaded &&
+          (source.main.length > 0 || source.textures.length > 0))
+        mMissing.push_back(cell);
+    }
+  }
+  std::sort(mMissing.begin(), mMissing.end(), byDistance);
+
+  // Make room by unloading the farthest chunks outside the wanted area
+  if (meshes.owns_lock() && mMissing.size() > mFreeSlots.size()) {
+    mEvictable.clear();
+    for (size_t i = 0; i < mSlots.size(); ++i) {
+      std::int32_t cell = mSlots[i].cell;
+      if (cell < 0 || mCellState[cell] != CellState::Loaded)
+        continue;
+      int x = cell % mChunksX;
+      int y = cell / mChunksX;
+      if (x < left || x > right || y < top || y > bottom)
+        mEvictable.push_back(static_cast<std::int32_t>(i));
+    }
+    std::sort(mEvictable.begin(), mEvictable.end(),
+              [&](std::int32_t a, std::int32_t b) {
+                return distance(mSlots[a].cell) > distance(mSlots[b].cell);
+              });
+    size_t needed = mMissing.size() - mFreeSlots.size();
+    for (size_t i = 0; i < std::min(needed, mEvictable.size()); ++i)
+      evict(mEvictable[i], renderer);
+  }
+
+  // Whatever doesn't fit in the pool stays conservative until it does
+  size_t count = std::min(mMissing.size(), mFreeSlots.size());
+  if (count == 0)
+    return;
+
+  std::unique_lock<std::mutex> lock(mMutex, std::defer_lock);
+  if (!wait)
+    lock.lock();
+  for (size_t i = 0; i < count; ++i) {
+    std::int32_t slot = mFreeSlots.back();
+    mFreeSlots.pop_back();
+    mSlots[slot].cell = mMissing[i];
+    mCellState[mMissing[i]] = CellState::Requested;
+    if (wait) {
+      load(mSlots[slot]);
+      install(slot, renderer);
+    } else {
+      mRequests.push_back(slot);
+    }
+  }
+  if (!wait) {
+    if (!mWorker.joinable())
+      mWorker = std::thread(&ChunkStreamer::workerLoop, this);
+    lock.unlock();
+    mWake.notify_one();
+  }
+}
+
+void ChunkStreamer::load(Slot &slot) const {
+  PROFILE_ZONE("ChunkStreamer::load");
+  const Source &source = mSources[slot.cell];
+
+  auto decode = [&](const ChunkData &data, std::string_view encoding,
+                    TileGrid::TileId *tiles) {
+    size_t written = 0;
+    if (data.length > 0) {
+      written = Map::decodeLayerData(
+          mContent.substr(data.offset, data.length), tiles, TILES, encoding);
+    }
+    std::fill(tiles + written, tiles + TILES, TileGrid::EMPTY);
+  };
+  decode(source.main, mMainEncoding, slot.main.data());
+  decode(source.textures, mTexturesEncoding, slot.textures.data());
+
+  slot.walls.fill(0);
+  for (int i = 0; i < TILES; ++i) {
+    if (mTypes.has(slot.main[i], TileTypes::SOLID))
+      slot.walls[i >> 6] |= std::uint64_t{1} << (i & 63);
+  }
+
+  slot.mesh.clear();
+  if (!mTileRects.empty()) {
+    int chunkX = slot.cell % mChunksX;
+    int chunkY = slot.cell / mChunksX;
+    TileRenderer::buildMesh(slot.mesh, slot.textures.data(), CHUNK_SIZE,
+                            {chunkX * CHUNK_SIZE, chunkY * CHUNK_SIZE},
+                            {CHUNK_SIZE, CHUNK_SIZE}, mTileRects, mTileSize);
+  }
+}
+
+void ChunkStreamer::install(std::int32_t slot, TileRenderer &renderer) {
+  Slot &loaded = mSlots[slot];
+  mSlotOf[loaded.cell] = slot;
+  mCellState[loaded.cell] = CellState::Loaded;
+  ++mLoadedCount;
+
+  // The renderer's empty array comes back in exchange, so vertex storage
+  // keeps cycling through the pool instead of being allocated
+  renderer.swapMesh(loaded.cell % mChunksX, loaded.cell / mChunksX,
+                    loaded.mesh);
+}
+
+void ChunkStreamer::evict(std::int32_t slot, TileRenderer &renderer) {
+  Slot &loaded = mSlots[slot];
+  renderer.swapMesh(loaded.cell % mChunksX, loaded.cell / mChunksX,
+                    loaded.mesh);
+  loaded.mesh.clear();
+
+  mSlotOf[loaded.cell] = -1;
+  mCellState[loaded.cell] = CellState::Unloaded;
+  loaded.cell = -1;
+  mFreeSlots.push_back(slot);
+  --mLoadedCount;
+}
+
+void ChunkStreamer::workerLoop() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (true) {
+    mWake.wait(lock, [this] { return mStopping || !mRequests.empty(); });
+    if (mStopping)
+      return;
+
+    // The slot is the worker's alone until it is handed back in mDone
+    std::int32_t slot = mRequests.front();
+    mRequests.pop_front();
+    lock.unlock();
+    load(mSlots[slot]);
+    lock.lock();
+    mDone.push_back(slot);
+  }
+}
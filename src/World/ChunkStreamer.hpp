@@ -0,0 +1,169 @@
+#pragma once
+#include "TileGrid.hpp"
+#include "TileTypes.hpp"
+#include <SFML/Graphics.hpp>
+#include <array>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+class MappedFile;
+class TileRenderer;
+
+// How much of a streamed map stays loaded
+struct StreamSettings {
+  // Chunks kept loaded beyond the camera's view, on every side
+  int radius = 4;
+
+  // Cap on the memory of loaded chunks (tiles, wall bits and meshes),
+  // which fixes how many can be loaded at once
+  std::size_t memoryBudget = std::size_t{32} << 20;
+
+  // Load on the calling thread in update(), so which chunks are loaded
+  // depends only on the camera (recording and replay need this)
+  bool synchronous = false;
+};
+
+// Keeps the chunks of a Tiled infinite map loaded around the camera, for
+// maps too large to hold in memory.
+//
+// The map file stays mapped and only an index of where each chunk's data
+// lies is kept. A fixed pool of slots, sized from the memory budget, holds
+// the decoded tiles, wall bits and mesh of the chunks in use; a worker
+// thread decodes requested chunks into free slots, nearest first, and the
+// owner installs them at its next update(). Chunks that aren't loaded are
+// treated as solid if they contain any wall, so nothing falls through
+// terrain that hasn't arrived yet.
+//
+// update() and isSolid() belong to one thread (the simulation). Meshes are
+// swapped into the TileRenderer under getMeshMutex(), which drawing holds
+// shared.
+class ChunkStreamer {
+public:
+  static constexpr int CHUNK_SIZE = 16; // Same as TileRenderer's
+
+  // Where a layer's data for one chunk lies in the map file
+  struct ChunkData {
+    std::uint64_t offset = 0;
+    std::uint32_t length = 0; // 0 if the layer has no such chunk
+  };
+
+  struct Source {
+    ChunkData main;
+    ChunkData textures;
+    // Answer for wall queries while not loaded: any SOLID or ONE_WAY tile
+    bool hasWalls = false;
+  };
+
+  // sources is chunksX * chunksY entries, row-major. mainEncoding and
+  // texturesEncoding are "csv" or "base64". Walls are the main layer
+  // tiles that types marks SOLID.
+  ChunkStreamer(int chunksX, int chunksY, std::vector<Source> sources,
+                std::string_view mainEncoding,
+                std::string_view texturesEncoding, const TileTypes &types,
+                const StreamSettings &settings);
+  ~ChunkStreamer();
+
+  ChunkStreamer(const ChunkStreamer &) = delete;
+  ChunkStreamer &operator=(const ChunkStreamer &) = delete;
+
+  // The file the sources point into, kept open while streaming
+  void setContent(std::unique_ptr<MappedFile> file);
+  void setContent(std::string content);
+
+  // Tile rects and size for building meshes (none are built without)
+  void setTileset(std::vector<sf::IntRect> tileRects, float tileSize);
+
+  // Installs finished chunks into renderer, unloads far ones and requests
+  // the missing ones around area (in pixels), nearest first. With wait
+  // (or StreamSettings::synchronous) they are loaded before returning.
+  void update(const sf::FloatRect &area, TileRenderer &renderer,
+              bool wait = false);
+
+  // Wall test for a tile inside the map (conservative if not loaded)
+  bool isSolid(int x, int y) const {
+    size_t cell =
+        static_cast<size_t>(y / CHUNK_SIZE) * mChunksX + x / CHUNK_SIZE;
+    std::int32_t slot = mSlotOf[cell];
+    if (slot < 0)
+      return mSources[cell].hasWalls;
+    int index = (y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE;
+    return (mSlots[slot].walls[index >> 6] >> (index & 63)) & 1u;
+  }
+
+  // Main layer tile, EMPTY if not loaded
+  TileGrid::TileId getTile(int x, int y) const {
+    size_t cell =
+        static_cast<size_t>(y / CHUNK_SIZE) * mChunksX + x / CHUNK_SIZE;
+    std::int32_t slot = mSlotOf[cell];
+    if (slot < 0)
+      return TileGrid::EMPTY;
+    return mSlots[slot].main[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE];
+  }
+
+  std::shared_mutex &getMeshMutex() { return mMeshMutex; }
+
+  size_t getSlotCount() const { return mSlots.size(); }
+  size_t getLoadedCount() const { return mLoadedCount; }
+
+private:
+  static constexpr int TILES = CHUNK_SIZE * CHUNK_SIZE;
+
+  struct Slot {
+    std::array<TileGrid::TileId, TILES> main;
+    std::array<TileGrid::TileId, TILES> textures;
+    std::array<std::uint64_t, TILES / 64> walls;
+    sf::VertexArray mesh{sf::PrimitiveType::Triangles};
+    std::int32_t cell = -1;
+  };
+
+  enum class CellState : std::uint8_t { Unloaded, Requested, Loaded };
+
+  void load(Slot &slot) const; // Decodes slot.cell into slot
+  void install(std::int32_t slot, TileRenderer &renderer);
+  void evict(std::int32_t slot, TileRenderer &renderer);
+  void workerLoop();
+
+  int mChunksX;
+  int mChunksY;
+  std::vector<Source> mSources;
+  std::string mMainEncoding;
+  std::string mTexturesEncoding;
+  TileTypes mTypes;
+  StreamSettings mSettings;
+
+  std::unique_ptr<MappedFile> mFile;
+  std::string mOwnedContent;
+  std::string_view mContent;
+
+  std::vector<sf::IntRect> mTileRects;
+  float mTileSize = 32.f;
+
+  // Owner thread state
+  std::vector<Slot> mSlots;
+  std::vector<std::int32_t> mSlotOf; // Per cell, -1 unless loaded
+  std::vector<CellState> mCellState;
+  std::vector<std::int32_t> mFreeSlots;
+  std::vector<std::int32_t> mFinished; // Loaded, not yet installed
+  std::vector<std::int32_t> mMissing;  // update() scratch
+  std::vector<std::int32_t> mEvictable;
+  size_t mLoadedCount = 0;
+
+  // Owner <-> worker, under mMutex
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  std::deque<std::int32_t> mRequests; // Slots to load, nearest first
+  std::vector<std::int32_t> mDone;
+  bool mStopping = false;
+  std::thread mWorker;
+
+  std::shared_mutex mMeshMutex;
+};
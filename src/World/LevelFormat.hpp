@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+
+// Precompiled binary level (.lvl), written by the tmx2lvl tool.
+//
+// The file is a fixed header followed by sections at the offsets it names.
+// Every section is 8-byte aligned and stored in the in-memory layout the
+// game uses (little-endian), so loading is a bounds check and a few copies.
+//
+//   LevelHeader
+//   main layer      width * height TileId (u16)
+//   texture layer   width * height TileId (u16)
+//   objects         objectCount LevelObject
+//   text objects    textCount LevelText
+//   image layers    imageLayerCount LevelImageLayer
+//   tile types      tileTypeCount LevelTileType
+//   strings         UTF-8 bytes referenced by LevelText, LevelImageLayer
+//                   and LevelObject
+namespace LevelFormat {
+
+constexpr char MAGIC[4] = {'J', 'T', 'C', 'L'};
+constexpr std::uint32_t VERSION = 4;
+
+struct LevelRect {
+  float x, y, width, height;
+};
+
+struct LevelText {
+  LevelRect bounds;
+  std::uint32_t nameOffset; // Into the string section
+  std::uint32_t nameLength;
+  std::uint32_t contentOffset;
+  std::uint32_t contentLength;
+};
+
+// A trigger, finish area, checkpoint or kill zone
+struct LevelObject {
+  LevelRect bounds;
+  std::uint32_t type;       // MapObjectType
+  std::uint32_t nameOffset; // Into the string section
+  std::uint32_t nameLength;
+  std::uint32_t reserved;
+};
+
+struct LevelImageLayer {
+  enum : std::uint32_t { REPEAT_X = 1, REPEAT_Y = 2 };
+
+  float offsetX, offsetY;
+  float parallaxX, parallaxY;
+  float scale;
+  std::uint32_t tint; // RGBA, as sf::Color::toInteger()
+  std::uint32_t flags;
+  std::uint32_t nameOffset; // Into the string section
+  std::uint32_t nameLength;
+  std::uint32_t sourceOffset; // Image path, relative to the level file
+  std::uint32_t sourceLength;
+  std::uint32_t reserved;
+};
+
+// One TileTypes::Entry
+struct LevelTileType {
+  std::uint16_t id;
+  std::uint8_t flags;
+  std::uint8_t reserved;
+  std::int32_t sourceX, sourceY; // In the tileset image
+  std::int32_t sourceWidth, sourceHeight;
+};
+
+struct LevelHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t width; // In tiles
+  std::uint32_t height;
+  float spawnX;
+  float spawnY;
+  std::uint32_t objectCount;
+  std::uint32_t textCount;
+  std::uint32_t imageLayerCount;
+  std::uint32_t tileTypeCount;
+
+  // Section offsets from the start of the file
+  std::uint64_t mainOffset;
+  std::uint64_t textureOffset;
+  std::uint64_t objectOffset;
+  std::uint64_t textOffset;
+  std::uint64_t imageLayerOffset;
+  std::uint64_t stringOffset;
+  std::uint64_t stringSize;
+  std::uint64_t tileTypeOffset;
+};
+
+static_assert(sizeof(LevelRect) == 16);
+static_assert(sizeof(LevelText) == 32);
+static_assert(sizeof(LevelObject) == 32);
+static_assert(sizeof(LevelImageLayer) == 48);
+static_assert(sizeof(LevelTileType) == 20);
+static_assert(sizeof(LevelHeader) == 104);
+
+} // namespace LevelFormat
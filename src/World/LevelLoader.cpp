@@ -0,0 +1,38 @@
+#include "LevelLoader.hpp"
+#include "../Core/Profiler.hpp"
+
+LevelLoader::~LevelLoader() {
+  if (mThread.joinable())
+    mThread.join();
+}
+
+void LevelLoader::start(std::unique_ptr<Map> map,
+                        const std::string &filename,
+                        std::shared_ptr<const Map> previous) {
+  if (isLoading())
+    return;
+
+  mFilename = filename;
+  mReady.store(false);
+  mProgress.store(0.f);
+  mResult = std::move(map);
+  mPrevious = std::move(previous);
+
+  // The worker owns mResult until it sets mReady
+  mThread = std::thread([this] {
+    PROFILE_ZONE("LevelLoader::load");
+    if (!mResult->loadData(mFilename, &mProgress, mPrevious.get()))
+      mResult.reset();
+    else if (!mPrevious)
+      mResult->buildTileMeshes();
+    mReady.store(true, std::memory_order_release);
+  });
+}
+
+std::unique_ptr<Map> LevelLoader::take() {
+  if (mThread.joinable())
+    mThread.join();
+  mReady.store(false);
+  mPrevious.reset();
+  return std::move(mResult);
+}
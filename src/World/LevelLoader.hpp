@@ -0,0 +1,47 @@
+#pragma once
+#include "Map.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+
+// Loads the next level into a separate Map on a worker thread.
+// The game keeps running (and drawing) the current map meanwhile, then
+// takes the finished one at a tick boundary. Only Map::loadData() runs on
+// the worker; the caller sets up the map's resources before start() and
+// finishes with Map::prepareGraphics() after take().
+class LevelLoader {
+public:
+  ~LevelLoader();
+
+  // Starts loading into map; ignored while another load is in flight.
+  // With previous (an earlier load of the same file, e.g. the level being
+  // played), unchanged layers are reused and tile meshes are not built:
+  // the caller copies what it can with Map::reuseTileMeshes() and builds
+  // the rest after take().
+  void start(std::unique_ptr<Map> map, const std::string &filename,
+             std::shared_ptr<const Map> previous = nullptr);
+
+  // True from start() until the result is taken
+  bool isLoading() const { return mThread.joinable(); }
+
+  // True once the worker finished (successfully or not)
+  bool isReady() const { return mReady.load(std::memory_order_acquire); }
+
+  // 0..1 while loading
+  float getProgress() const { return mProgress.load(); }
+
+  const std::string &getFilename() const { return mFilename; }
+
+  // Joins the worker and returns the loaded map, or nullptr on failure.
+  // Call once isReady() is true.
+  std::unique_ptr<Map> take();
+
+private:
+  std::thread mThread;
+  std::atomic<bool> mReady{false};
+  std::atomic<float> mProgress{0.f};
+  std::string mFilename;
+  std::unique_ptr<Map> mResult;
+  std::shared_ptr<const Map> mPrevious; // Kept alive while the worker runs
+};
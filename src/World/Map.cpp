@@ -1,455 +1,1656 @@
 #include "Map.hpp"
+#include "../Core/JobSystem.hpp"
+#include "../Core/MappedFile.hpp"
+#include "../Core/Profiler.hpp"
+#include "../Core/ResourceCache.hpp"
+#include "../Graphics/TextureAtlas.hpp"
+#include "LevelFormat.hpp"
 #include <algorithm>
+#include <bit>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
-#include <sstream>
+#include <limits>
+
+// The binary level format is stored little-endian and loaded by memcpy
+static_assert(std::endian::native == std::endian::little);
+
+void Map::loadResources(const TextureAtlas &atlas) {
+  // Tileset image; which of its tiles are drawn, and where, comes from the
+  // map's tilesets once it's parsed (see finishLoad())
+  const TextureAtlas::Region *tileset = atlas.find("tileset");
+  if (tileset) {
+    tilesetTexture = tileset->texture;
+    tilesetOrigin = tileset->rect.position;
+  } else {
+    std::cerr << "Tileset missing from texture atlas" << std::endl;
+  }
 
-Map::Map() {
-  tileShape.setSize({TILE_SIZE, TILE_SIZE});
-  tileShape.setFillColor(sf::Color::White);
+  // Font for text objects (shared with the HUD)
+  font = Resources::fonts().get("assets/fonts/font.ttf");
+  hasResources = true;
+}
 
-  // Load Textures
-  if (!finishTexture.loadFromFile("assets/tiles/flag.png")) {
-    std::cerr << "Failed to load flag.png" << std::endl;
+bool Map::loadFromFile(const std::string &filename) {
+  if (!loadData(filename))
+    return false;
+  prepareGraphics();
+  return true;
+}
+
+bool Map::loadData(const std::string &filename, std::atomic<float> *progress,
+                   const Map *previous) {
+  // Check file extension
+  std::string extension = filename.substr(filename.find_last_of(".") + 1);
+  bool isTMX = extension == "tmx";
+  bool isBinary = extension == "lvl";
+  if (!isTMX && !isBinary) {
+    std::cerr << "Error: Only .tmx and .lvl map files are supported."
+              << std::endl;
+    return false;
   }
-  if (!spawnTexture.loadFromFile("assets/tiles/void.png")) {
-    std::cerr << "Failed to load void.png" << std::endl;
+
+  // Map the file and parse it in place (no copy of the content)
+  auto file = std::make_unique<MappedFile>();
+  if (!file->open(filename)) {
+    std::cerr << "Failed to open map file: " << filename << std::endl;
+    return false;
   }
-  if (!wallTexture.loadFromFile("assets/tiles/planks.png")) {
-    std::cerr << "Failed to load planks.png" << std::endl;
+
+  directory = std::filesystem::path(filename).parent_path().string();
+  loadProgress = progress;
+  previousVersion = previous;
+  bool loaded = isTMX ? parseTMX(file->view()) : parseBinary(file->view());
+  loadProgress = nullptr;
+  previousVersion = nullptr;
+
+  // A streamed map reads its chunks from the file as it goes. The chunks
+  // around the spawn are loaded now, so play starts on solid ground.
+  if (loaded && streamer) {
+    streamer->setContent(std::move(file));
+    streamer->update(sf::FloatRect(startPosition, {0.f, 0.f}), tileRenderer,
+                     true);
   }
 
-  // Load font for text objects
-  fontLoaded = font.openFromFile("assets/fonts/font.ttf");
-  if (!fontLoaded) {
-    std::cerr << "Failed to load font for map text" << std::endl;
+  if (progress)
+    progress->store(1.f);
+  return loaded;
+}
+
+void Map::updateStreaming(const sf::View &view) {
+  if (!streamer)
+    return;
+  sf::FloatRect area(view.getCenter() - view.getSize() / 2.f, view.getSize());
+  streamer->update(area, tileRenderer);
+}
+
+namespace {
+
+bool isSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// Name of an XML tag, given the text between '<' and '>'
+std::string_view tagName(std::string_view tag) {
+  size_t start = (!tag.empty() && tag[0] == '/') ? 1 : 0;
+  size_t end = start;
+  while (end < tag.size() && !isSpace(tag[end]) && tag[end] != '/')
+    ++end;
+  return tag.substr(start, end - start);
+}
+
+// Value of an attribute inside a tag, or an empty view if it is missing.
+// The name must be preceded by whitespace so "width" never matches
+// "tilewidth".
+std::string_view extractAttribute(std::string_view tag,
+                                  std::string_view attrName) {
+  size_t pos = 0;
+  while ((pos = tag.find(attrName, pos)) != std::string_view::npos) {
+    size_t valueStart = pos + attrName.size();
+    bool nameStart = pos > 0 && isSpace(tag[pos - 1]);
+    if (nameStart && valueStart + 1 < tag.size() && tag[valueStart] == '=' &&
+        tag[valueStart + 1] == '"') {
+      valueStart += 2;
+      size_t valueEnd = tag.find('"', valueStart);
+      if (valueEnd == std::string_view::npos)
+        return {};
+      return tag.substr(valueStart, valueEnd - valueStart);
+    }
+    pos = valueStart;
   }
+  return {};
 }
 
-bool Map::loadFromFile(const std::string &filename) {
-  std::ifstream file(filename);
-  if (!file.is_open()) {
-    std::cerr << "Failed to open map file: " << filename << std::endl;
+template <typename T> bool parseNumber(std::string_view text, T &value) {
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+// Tiled colors are "#rrggbb" or "#aarrggbb"
+bool parseColor(std::string_view text, sf::Color &color) {
+  if (text.size() != 7 && text.size() != 9)
+    return false;
+  if (text[0] != '#')
     return false;
+  std::uint32_t value = 0;
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data() + 1, end, value, 16);
+  if (result.ec != std::errc() || result.ptr != end)
+    return false;
+
+  std::uint8_t alpha = text.size() == 9 ? value >> 24 : 255;
+  color = sf::Color((value >> 16) & 0xFF, (value >> 8) & 0xFF, value & 0xFF,
+                    alpha);
+  return true;
+}
+
+// Tiled GIDs are 1-based, 0 means empty. Strip the flip flags stored in the
+// top bits; anything that still doesn't fit a TileId is treated as empty.
+TileGrid::TileId toTileId(std::uint32_t gid) {
+  gid &= 0x0FFFFFFFu;
+  return gid <= 0xFFFF ? static_cast<TileGrid::TileId>(gid) : TileGrid::EMPTY;
+}
+
+// Decodes comma separated GIDs straight into the tile buffer.
+// Returns the number of cells written.
+size_t decodeCSV(std::string_view data, TileGrid::TileId *tiles,
+                 size_t count) {
+  const char *cur = data.data();
+  const char *end = cur + data.size();
+  size_t index = 0;
+
+  while (index < count && cur < end) {
+    // Skip separators (commas and the newline at the end of each row)
+    if (*cur == ',' || isSpace(*cur)) {
+      ++cur;
+      continue;
+    }
+
+    std::uint32_t gid = 0;
+    auto result = std::from_chars(cur, end, gid);
+    if (result.ec == std::errc()) {
+      tiles[index++] = toTileId(gid);
+      cur = result.ptr;
+    } else {
+      // Malformed cell: store empty and skip to the next separator
+      tiles[index++] = TileGrid::EMPTY;
+      while (cur < end && *cur != ',')
+        ++cur;
+    }
   }
+  return index;
+}
 
-  // Read entire file content
-  std::stringstream buffer;
-  buffer << file.rdbuf();
-  std::string content = buffer.str();
+// Large CSV layers are cut into pieces that each end just after a comma,
+// where decodeCSV starts a fresh cell (even after a malformed one), so the
+// pieces decode independently. They are decoded in parallel into scratch
+// buffers and copied into place in order.
+size_t decodeCSVParallel(std::string_view data, TileGrid::TileId *tiles,
+                         size_t count) {
+  constexpr size_t PIECE_BYTES = 256 * 1024;
+  JobSystem &jobs = JobSystem::instance();
+  if (data.size() < 2 * PIECE_BYTES || jobs.getWorkerCount() == 0)
+    return decodeCSV(data, tiles, count);
+
+  std::vector<std::string_view> pieces;
+  size_t start = 0;
+  while (start < data.size()) {
+    size_t end = data.find(',', std::min(start + PIECE_BYTES, data.size()));
+    end = end == std::string_view::npos ? data.size() : end + 1;
+    pieces.push_back(data.substr(start, end - start));
+    start = end;
+  }
 
-  // Check file extension
-  bool isTMX = filename.substr(filename.find_last_of(".") + 1) == "tmx";
-  if (!isTMX) {
-    std::cerr << "Error: Only .tmx map files are supported." << std::endl;
+  std::vector<std::vector<TileGrid::TileId>> decoded(pieces.size());
+  jobs.parallelForWait(pieces.size(), 1, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      // Every cell but the last takes a digit and a separator
+      decoded[i].resize(pieces[i].size() / 2 + 1);
+      decoded[i].resize(
+          decodeCSV(pieces[i], decoded[i].data(), decoded[i].size()));
+    }
+  });
+
+  size_t written = 0;
+  for (const std::vector<TileGrid::TileId> &piece : decoded) {
+    size_t n = std::min(piece.size(), count - written);
+    std::memcpy(tiles + written, piece.data(), n * sizeof(TileGrid::TileId));
+    written += n;
+  }
+  return written;
+}
+
+int base64Value(char c) {
+  if (c >= 'A' && c <= 'Z')
+    return c - 'A';
+  if (c >= 'a' && c <= 'z')
+    return c - 'a' + 26;
+  if (c >= '0' && c <= '9')
+    return c - '0' + 52;
+  if (c == '+')
+    return 62;
+  if (c == '/')
+    return 63;
+  return -1;
+}
+
+// Decodes base64 data of little-endian 32-bit GIDs straight into the tile
+// buffer, without an intermediate byte array. Returns the cells written.
+size_t decodeBase64(std::string_view data, TileGrid::TileId *tiles,
+                    size_t count) {
+  std::uint32_t bits = 0; // Pending base64 bits
+  int bitCount = 0;
+  std::uint32_t gid = 0; // GID being assembled, byte by byte
+  int gidBytes = 0;
+  size_t index = 0;
+
+  for (char c : data) {
+    int value = base64Value(c);
+    if (value < 0) // Whitespace and '=' padding
+      continue;
+
+    bits = (bits << 6) | static_cast<std::uint32_t>(value);
+    bitCount += 6;
+    if (bitCount < 8)
+      continue;
+
+    bitCount -= 8;
+    std::uint32_t byte = (bits >> bitCount) & 0xFF;
+    gid |= byte << (gidBytes * 8);
+    if (++gidBytes == 4) {
+      if (index == count)
+        break;
+      tiles[index++] = toTileId(gid);
+      gid = 0;
+      gidBytes = 0;
+    }
+  }
+  return index;
+}
+
+// Fingerprint of a row of layer text. Takes eight bytes a step, as it
+// reads every row of every load.
+std::uint64_t hashRow(std::string_view text) {
+  constexpr std::uint64_t PRIME = 0x100000001b3ull;
+  std::uint64_t hash = 0xcbf29ce484222325ull ^ text.size();
+  size_t i = 0;
+  for (; i + 8 <= text.size(); i += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, text.data() + i, sizeof(word));
+    hash = (hash ^ word) * PRIME;
+    hash ^= hash >> 32;
+  }
+  for (; i < text.size(); ++i)
+    hash = (hash ^ static_cast<unsigned char>(text[i])) * PRIME;
+  return hash;
+}
+
+// Decodes CSV layer data one line per row, as Tiled writes it, hashing
+// each row's text into rowHashes. Rows whose hash is the same in
+// previousHashes are copied from previous (the same layer of an earlier
+// load) instead, so reloading a large map only decodes the rows that were
+// edited. Returns false, leaving grid alone, if the lines don't match the
+// rows.
+bool decodeCSVRows(std::string_view data, int width, int height,
+                   TileGrid &grid, std::vector<std::uint64_t> &rowHashes,
+                   const TileGrid *previous,
+                   const std::vector<std::uint64_t> *previousHashes) {
+  std::vector<std::string_view> rows;
+  rows.reserve(height);
+  size_t start = 0;
+  while (start < data.size()) {
+    size_t end = std::min(data.find('\n', start), data.size());
+    std::string_view line = data.substr(start, end - start);
+    start = end + 1;
+    if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+      continue; // Blank lines around the rows
+    if (rows.size() == static_cast<size_t>(height))
+      return false;
+    rows.push_back(line);
+  }
+  if (rows.size() != static_cast<size_t>(height))
     return false;
+
+  bool reuse = previous && previousHashes &&
+               previous->getWidth() == width &&
+               previous->getHeight() == height &&
+               previousHashes->size() == rows.size();
+  grid.resize(width, height);
+  rowHashes.assign(rows.size(), 0);
+
+  std::atomic<size_t> written{0};
+  JobSystem::instance().parallelForWait(
+      rows.size(), 64, [&](size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t y = begin; y < end; ++y) {
+          int row = static_cast<int>(y);
+          rowHashes[y] = hashRow(rows[y]);
+          if (reuse && rowHashes[y] == (*previousHashes)[y]) {
+            std::memcpy(grid.row(row), previous->row(row),
+                        width * sizeof(TileGrid::TileId));
+            count += width;
+          } else {
+            count += decodeCSV(rows[y], grid.row(row), width);
+          }
+        }
+        written.fetch_add(count);
+      });
+
+  if (written < grid.size()) {
+    std::cerr << "Warning: layer data has " << written.load()
+              << " tiles, expected " << grid.size() << std::endl;
   }
+  return true;
+}
 
-  return parseTMX(content);
+// Wall bits of tiles [first, last), at most 64
+std::uint64_t solidBits(const TileTypes &types,
+                        const TileGrid::TileId *tiles, size_t first,
+                        size_t last) {
+  std::uint64_t bits = 0;
+  for (size_t i = first; i < last; ++i) {
+    if (types.has(tiles[i], TileTypes::SOLID))
+      bits |= std::uint64_t{1} << (i - first);
+  }
+  return bits;
 }
 
-// Helper function to extract attribute value from XML tag
-std::string extractAttribute(const std::string &tag,
-                             const std::string &attrName) {
-  std::string search = attrName + "=\"";
-  size_t start = tag.find(search);
-  if (start == std::string::npos)
-    return "";
-  start += search.length();
-  size_t end = tag.find("\"", start);
-  if (end == std::string::npos)
-    return "";
-  return tag.substr(start, end - start);
+// Object type named by a Tiled class or layer name ("trigger", "finish",
+// "checkpoint", "killzone", or their plurals)
+bool parseObjectType(std::string_view text, MapObjectType &type) {
+  static constexpr std::pair<std::string_view, MapObjectType> NAMES[] = {
+      {"trigger", MapObjectType::Trigger},
+      {"triggers", MapObjectType::Trigger},
+      {"finish", MapObjectType::Finish},
+      {"checkpoint", MapObjectType::Checkpoint},
+      {"checkpoints", MapObjectType::Checkpoint},
+      {"killzone", MapObjectType::KillZone},
+      {"killzones", MapObjectType::KillZone},
+      {"kill-zone", MapObjectType::KillZone},
+      {"kill-zones", MapObjectType::KillZone},
+  };
+  for (const auto &[name, value] : NAMES) {
+    if (text == name) {
+      type = value;
+      return true;
+    }
+  }
+  return false;
 }
 
-// Helper to extract content between tags
-std::string extractBetweenTags(const std::string &content,
-                               const std::string &startTag,
-                               const std::string &endTag, size_t searchFrom = 0,
-                               size_t *foundEnd = nullptr) {
-  size_t start = content.find(startTag, searchFrom);
-  if (start == std::string::npos)
-    return "";
-  start += startTag.length();
-  size_t end = content.find(endTag, start);
-  if (end == std::string::npos)
-    return "";
-  if (foundEnd)
-    *foundEnd = end + endTag.length();
-  return content.substr(start, end - start);
-}
-
-bool Map::parseTMX(const std::string &content) {
-  mainGrid.clear();
-  textureGrid.clear();
-  textObjects.clear();
-  finishAreas.clear();
+// Tile types of maps whose tilesets have no properties, as the tiles of
+// the original tileset were hard-coded: 1 spawn, 2 finish, 3 wall and the
+// drawn 4..6 (void, flag, planks), one 32x32 column per ID
+void addBuiltinTileTypes(TileTypes &types) {
+  const std::uint8_t flags[] = {TileTypes::SPAWN, TileTypes::FINISH,
+                                TileTypes::SOLID, TileTypes::RENDER,
+                                TileTypes::RENDER, TileTypes::RENDER};
+  for (int i = 0; i < 6; ++i) {
+    types.add({static_cast<TileGrid::TileId>(i + 1), flags[i],
+               sf::IntRect({i * 32, 0}, {32, 32})});
+  }
+}
+
+// A path relative to directory `from`, rewritten relative to `to` (an
+// absolute path when the two share no root)
+std::string rebasePath(const std::string &path, const std::string &from,
+                       const std::string &to) {
+  namespace fs = std::filesystem;
+  fs::path base = to.empty() ? fs::current_path() : fs::absolute(to);
+  fs::path target = fs::absolute(fs::path(from) / path).lexically_normal();
+  fs::path rebased = target.lexically_relative(base.lexically_normal());
+  return (rebased.empty() ? target : rebased).generic_string();
+}
+
+// Whether source (relative to directory) is TILESET_IMAGE, compared by
+// its last path components since assets may be anywhere
+bool isTilesetImage(const std::string &directory, std::string_view source) {
+  std::filesystem::path image =
+      (std::filesystem::path(directory) / source).lexically_normal();
+  std::filesystem::path expected(Map::TILESET_IMAGE);
+  auto imagePart = image.end();
+  for (auto part = expected.end(); part != expected.begin();) {
+    if (imagePart == image.begin() || *--part != *--imagePart)
+      return false;
+  }
+  return true;
+}
 
-  // Extract map dimensions
-  size_t mapTagStart = content.find("<map ");
-  size_t mapTagEnd = content.find(">", mapTagStart);
-  std::string mapTag = content.substr(mapTagStart, mapTagEnd - mapTagStart);
+} // namespace
 
-  int mapWidth = std::stoi(extractAttribute(mapTag, "width"));
-  int mapHeight = std::stoi(extractAttribute(mapTag, "height"));
+std::vector<std::string> Map::findTilesetFiles(const std::string &tmx) {
+  std::vector<std::string> files;
+  MappedFile file;
+  if (!file.open(tmx))
+    return files;
 
-  // Parse layers
+  // Tiled writes the tilesets before any layer, so stop at the first data
+  std::string_view content = file.view();
+  content = content.substr(0, content.find("<data"));
+  std::string directory = std::filesystem::path(tmx).parent_path().string();
   size_t pos = 0;
-  while (true) {
-    size_t layerStart = content.find("<layer ", pos);
-    if (layerStart == std::string::npos)
+  while ((pos = content.find("<tileset", pos)) != std::string_view::npos) {
+    size_t tagEnd = content.find('>', pos);
+    if (tagEnd == std::string_view::npos)
       break;
+    std::string_view source =
+        extractAttribute(content.substr(pos + 1, tagEnd - pos - 1), "source");
+    if (!source.empty())
+      files.push_back((std::filesystem::path(directory) / source).string());
+    pos = tagEnd + 1;
+  }
+  return files;
+}
 
-    size_t layerTagEnd = content.find(">", layerStart);
-    std::string layerTag = content.substr(layerStart, layerTagEnd - layerStart);
-    std::string layerName = extractAttribute(layerTag, "name");
+bool Map::parseTMX(std::string_view content) {
+  mainGrid.clear();
+  textureGrid.clear();
+  solidMask.clear();
+  textObjects.clear();
+  imageLayers.clear();
+  objects.clear();
+  mainRowHashes.clear();
+  textureRowHashes.clear();
+  streamer.reset();
+  tileTypes.clear();
+
+  int mapWidth = 0;
+  int mapHeight = 0;
+  bool infinite = false;
+  bool tilesetImageSeen = false;
+
+  // Parser state, filled as tags are scanned in a single pass
+  std::string_view layerName;
+  int layerWidth = 0;
+  int layerHeight = 0;
+  // Type of the current object layer, if its class or name gives one
+  MapObjectType groupType = MapObjectType::Trigger;
+  bool groupTyped = false;
+  bool inObject = false;
+  bool objectTyped = false;
+  MapObject object;
+  MapText text;
+  bool inImageLayer = false;
+  bool imageLayerVisible = true;
+  ImageLayer imageLayer;
+
+  // Infinite maps: the <data> being scanned for chunks (-1 none, 0 main,
+  // 1 textures), each layer's encoding, and the chunks found
+  int chunkLayer = -1;
+  std::string_view chunkEncodings[2] = {"csv", "csv"};
+  std::vector<ChunkEntry> chunks;
+
+  // Layer data is decoded after the scan, all layers at once on the job
+  // system (it is nearly all of the parsing work)
+  struct PendingLayer {
+    TileGrid *target;
+    std::vector<std::uint64_t> *rowHashes;
+    // Same layer of previousVersion, if any
+    const TileGrid *previous;
+    const std::vector<std::uint64_t> *previousHashes;
+    std::string_view data;
+    int width;
+    int height;
+    std::string_view encoding;
+  };
+  std::vector<PendingLayer> pendingLayers;
 
-    // Find the CSV data within this layer
-    size_t dataStart = content.find("<data encoding=\"csv\">", layerStart);
-    size_t dataEnd = content.find("</data>", dataStart);
+  size_t pos = 0;
+  while ((pos = content.find('<', pos)) != std::string_view::npos) {
+    // Skip comments (they may contain '>')
+    if (content.compare(pos, 4, "<!--") == 0) {
+      size_t commentEnd = content.find("-->", pos + 4);
+      if (commentEnd == std::string_view::npos)
+        break;
+      pos = commentEnd + 3;
+      continue;
+    }
 
-    if (dataStart != std::string::npos && dataEnd != std::string::npos) {
-      std::string csvData = content.substr(
-          dataStart + 21, dataEnd - (dataStart + 21)); // 21 = length of opening
-                                                       // tag
+    size_t tagStart = pos;
+    size_t tagEnd = content.find('>', pos);
+    if (tagEnd == std::string_view::npos)
+      break;
 
-      auto grid = parseLayerData(csvData, mapWidth, mapHeight);
+    std::string_view tag = content.substr(pos + 1, tagEnd - pos - 1);
+    pos = tagEnd + 1;
+    if (tag.empty() || tag[0] == '?' || tag[0] == '!')
+      continue;
 
+    bool closing = tag[0] == '/';
+    bool selfClosing = tag.back() == '/';
+    std::string_view name = tagName(tag);
+
+    if (closing) {
+      if (name == "objectgroup") {
+        groupTyped = false;
+      } else if (name == "object") {
+        // An object with a <text> is a sign, whatever its layer
+        if (inObject && !text.content.empty())
+          textObjects.push_back(std::move(text));
+        else if (inObject && objectTyped)
+          objects.push_back(std::move(object));
+        inObject = false;
+      } else if (name == "imagelayer") {
+        if (inImageLayer && imageLayerVisible && !imageLayer.source.empty())
+          imageLayers.push_back(std::move(imageLayer));
+        inImageLayer = false;
+      } else if (name == "data") {
+        chunkLayer = -1;
+      }
+      continue;
+    }
+
+    if (name == "map") {
+      parseNumber(extractAttribute(tag, "width"), mapWidth);
+      parseNumber(extractAttribute(tag, "height"), mapHeight);
+      infinite = extractAttribute(tag, "infinite") == "1";
+    } else if (name == "tileset") {
+      std::uint32_t firstGid = 1;
+      parseNumber(extractAttribute(tag, "firstgid"), firstGid);
+      std::string_view source = extractAttribute(tag, "source");
+      if (!source.empty()) {
+        // External .tsx, relative to the map
+        std::string path =
+            (std::filesystem::path(directory) / source).string();
+        MappedFile file;
+        if (file.open(path))
+          parseTileset(file.view(), firstGid,
+                       std::filesystem::path(path).parent_path().string(),
+                       tilesetImageSeen);
+        else
+          std::cerr << "Failed to open tileset " << path << std::endl;
+      } else if (!selfClosing) {
+        size_t tilesetEnd = content.find("</tileset>", pos);
+        if (tilesetEnd == std::string_view::npos)
+          break;
+        parseTileset(content.substr(tagStart, tilesetEnd - tagStart),
+                     firstGid, directory, tilesetImageSeen);
+        pos = tilesetEnd + 10; // Move past </tileset>
+      }
+    } else if (name == "layer") {
+      layerName = extractAttribute(tag, "name");
+      layerWidth = mapWidth;
+      layerHeight = mapHeight;
+      parseNumber(extractAttribute(tag, "width"), layerWidth);
+      parseNumber(extractAttribute(tag, "height"), layerHeight);
+    } else if (name == "data" && !selfClosing && infinite) {
+      // Infinite layers are split into <chunk>s, indexed below rather than
+      // decoded
+      chunkLayer = layerName == "main" ? 0 : layerName == "textures" ? 1 : -1;
+      std::string_view encoding = extractAttribute(tag, "encoding");
+      if (chunkLayer >= 0 &&
+          (!extractAttribute(tag, "compression").empty() ||
+           (encoding != "csv" && encoding != "base64"))) {
+        std::cerr << "Error: unsupported chunk data in layer " << layerName
+                  << std::endl;
+        chunkLayer = -1;
+      }
+      if (chunkLayer >= 0)
+        chunkEncodings[chunkLayer] = encoding;
+    } else if (name == "chunk" && !selfClosing && chunkLayer >= 0) {
+      size_t chunkEnd = content.find("</chunk>", pos);
+      if (chunkEnd == std::string_view::npos)
+        break;
+      ChunkEntry chunk{chunkLayer == 1, 0, 0, 0, 0,
+                       content.substr(pos, chunkEnd - pos)};
+      parseNumber(extractAttribute(tag, "x"), chunk.x);
+      parseNumber(extractAttribute(tag, "y"), chunk.y);
+      parseNumber(extractAttribute(tag, "width"), chunk.width);
+      parseNumber(extractAttribute(tag, "height"), chunk.height);
+      chunks.push_back(chunk);
+      pos = chunkEnd + 8; // Move past </chunk>
+    } else if (name == "data" && !selfClosing) {
+      size_t dataEnd = content.find("</data>", pos);
+      if (dataEnd == std::string_view::npos)
+        break;
+      std::string_view data = content.substr(pos, dataEnd - pos);
+      pos = dataEnd + 7; // Move past </data>
+
+      // Only the layers the game uses are decoded
+      TileGrid *target = nullptr;
+      std::vector<std::uint64_t> *rowHashes = nullptr;
+      const TileGrid *previous = nullptr;
+      const std::vector<std::uint64_t> *previousHashes = nullptr;
       if (layerName == "main") {
-        mainGrid = grid;
-
-        // Find spawn and finish in main grid
-        // After -1 adjustment: 0=spawn, 1=finish, 2=wall, 3=text
-        int spawnCount = 0;
-        for (size_t y = 0; y < mainGrid.size(); ++y) {
-          for (size_t x = 0; x < mainGrid[y].size(); ++x) {
-            int id = mainGrid[y][x];
-
-            if (id == 0) { // Spawn (Tiled ID 1)
-              if (spawnCount > 0) {
-                std::cerr << "Warning: Multiple spawn points found!"
-                          << std::endl;
-              }
-              startPosition = {
-                  static_cast<float>(x) * TILE_SIZE + TILE_SIZE / 2.f,
-                  static_cast<float>(y) * TILE_SIZE + TILE_SIZE / 2.f};
-              spawnCount++;
-            } else if (id == 1) { // Finish (Tiled ID 2)
-              finishAreas.push_back(
-                  sf::FloatRect({static_cast<float>(x) * TILE_SIZE,
-                                 static_cast<float>(y) * TILE_SIZE},
-                                {TILE_SIZE, TILE_SIZE}));
-            }
-          }
+        target = &mainGrid;
+        rowHashes = &mainRowHashes;
+        if (previousVersion) {
+          previous = &previousVersion->mainGrid;
+          previousHashes = &previousVersion->mainRowHashes;
         }
       } else if (layerName == "textures") {
-        textureGrid = grid;
+        target = &textureGrid;
+        rowHashes = &textureRowHashes;
+        if (previousVersion) {
+          previous = &previousVersion->textureGrid;
+          previousHashes = &previousVersion->textureRowHashes;
+        }
       }
+      if (!target)
+        continue;
+
+      if (!extractAttribute(tag, "compression").empty()) {
+        std::cerr << "Error: compressed layer data is not supported (layer "
+                  << layerName << ")" << std::endl;
+        continue;
+      }
+      pendingLayers.push_back({target, rowHashes, previous, previousHashes,
+                               data, layerWidth, layerHeight,
+                               extractAttribute(tag, "encoding")});
+    } else if (name == "objectgroup") {
+      groupTyped = parseObjectType(extractAttribute(tag, "class"),
+                                   groupType) ||
+                   parseObjectType(extractAttribute(tag, "name"), groupType);
+    } else if (name == "object") {
+      text = MapText();
+      text.name = extractAttribute(tag, "name");
+      parseNumber(extractAttribute(tag, "x"), text.position.x);
+      parseNumber(extractAttribute(tag, "y"), text.position.y);
+      parseNumber(extractAttribute(tag, "width"), text.size.x);
+      parseNumber(extractAttribute(tag, "height"), text.size.y);
+
+      // Tiled 1.9+ writes "class", older versions "type"
+      object = MapObject{MapObjectType::Trigger,
+                         sf::FloatRect(text.position, text.size), text.name};
+      objectTyped = parseObjectType(extractAttribute(tag, "class"),
+                                    object.type) ||
+                    parseObjectType(extractAttribute(tag, "type"),
+                                    object.type);
+      if (!objectTyped && groupTyped) {
+        object.type = groupType;
+        objectTyped = true;
+      }
+
+      inObject = !selfClosing;
+      if (selfClosing && objectTyped)
+        objects.push_back(std::move(object));
+    } else if (name == "imagelayer" && !selfClosing) {
+      inImageLayer = true;
+      imageLayerVisible = extractAttribute(tag, "visible") != "0";
+      imageLayer = ImageLayer();
+      imageLayer.name = extractAttribute(tag, "name");
+      parseNumber(extractAttribute(tag, "offsetx"), imageLayer.offset.x);
+      parseNumber(extractAttribute(tag, "offsety"), imageLayer.offset.y);
+      parseNumber(extractAttribute(tag, "parallaxx"), imageLayer.parallax.x);
+      parseNumber(extractAttribute(tag, "parallaxy"), imageLayer.parallax.y);
+      imageLayer.repeatX = extractAttribute(tag, "repeatx") == "1";
+      imageLayer.repeatY = extractAttribute(tag, "repeaty") == "1";
+      parseColor(extractAttribute(tag, "tintcolor"), imageLayer.tint);
+      float opacity = 1.f;
+      if (parseNumber(extractAttribute(tag, "opacity"), opacity)) {
+        imageLayer.tint.a = static_cast<std::uint8_t>(
+            imageLayer.tint.a * std::clamp(opacity, 0.f, 1.f));
+      }
+    } else if (name == "image" && inImageLayer) {
+      imageLayer.source = extractAttribute(tag, "source");
+    } else if (name == "property" && inImageLayer) {
+      if (extractAttribute(tag, "name") == "scale")
+        parseNumber(extractAttribute(tag, "value"), imageLayer.scale);
+    } else if (name == "text" && inObject && !selfClosing) {
+      // Extract text content between <text> tags
+      size_t textEnd = content.find("</text>", pos);
+      if (textEnd == std::string_view::npos)
+        break;
+      text.content = content.substr(pos, textEnd - pos);
+      pos = textEnd + 7; // Move past </text>
     }
+  }
 
-    pos = dataEnd + 7; // Move past </data>
+  if (tileTypes.empty()) {
+    std::cerr << "Warning: no tile properties in the map's tilesets, using "
+                 "the built-in tile types"
+              << std::endl;
+    addBuiltinTileTypes(tileTypes);
   }
 
-  // Parse object groups (for text)
-  parseObjectGroup(content);
+  if (infinite) {
+    bool indexed =
+        indexChunks(content, chunks, chunkEncodings[0], chunkEncodings[1]);
+    if (indexed) {
+      std::cout << "Loaded infinite TMX map: " << widthInTiles << "x"
+                << heightInTiles << " tiles in " << chunks.size()
+                << " chunks, streamed" << std::endl;
+    }
+    return indexed;
+  }
 
-  // Prepare cached text objects (optimization: avoid allocation in render loop)
-  prepareTextObjects();
+  // Decode the layers. Progress follows the decoded bytes, since layer
+  // data is nearly all of the file.
+  {
+    PROFILE_ZONE("Map::decodeLayers");
+    JobSystem &jobs = JobSystem::instance();
+    std::atomic<size_t> decodedBytes{0};
+    std::vector<JobSystem::Handle> decoded;
+    for (const PendingLayer &layer : pendingLayers) {
+      decoded.push_back(jobs.schedule([this, &layer, &decodedBytes, &content] {
+        // CSV goes row by row, so a reload only decodes edited rows
+        if (layer.encoding != "csv" ||
+            !decodeCSVRows(layer.data, layer.width, layer.height,
+                           *layer.target, *layer.rowHashes, layer.previous,
+                           layer.previousHashes)) {
+          layer.rowHashes->clear();
+          *layer.target = parseLayerData(layer.data, layer.width,
+                                         layer.height, layer.encoding);
+        }
+        size_t done = decodedBytes.fetch_add(layer.data.size()) +
+                      layer.data.size();
+        if (loadProgress)
+          loadProgress->store(0.9f * done / content.size());
+      }));
+    }
+    for (const JobSystem::Handle &handle : decoded)
+      jobs.wait(handle);
+  }
+
+  // Find spawn and finish in main grid
+  int spawnCount = 0;
+  for (int y = 0; y < mainGrid.getHeight(); ++y) {
+    const TileGrid::TileId *row = mainGrid.row(y);
+    for (int x = 0; x < mainGrid.getWidth(); ++x) {
+      std::uint8_t flags = tileTypes.get(row[x]);
+
+      if (flags & TileTypes::SPAWN) {
+        if (spawnCount > 0) {
+          std::cerr << "Warning: Multiple spawn points found!" << std::endl;
+        }
+        startPosition = {static_cast<float>(x) * TILE_SIZE + TILE_SIZE / 2.f,
+                         static_cast<float>(y) * TILE_SIZE + TILE_SIZE / 2.f};
+        spawnCount++;
+      } else if (flags & TileTypes::FINISH) {
+        objects.push_back({MapObjectType::Finish,
+                           sf::FloatRect({static_cast<float>(x) * TILE_SIZE,
+                                          static_cast<float>(y) * TILE_SIZE},
+                                         {TILE_SIZE, TILE_SIZE}),
+                           {}});
+      }
+    }
+  }
+
+  finishLoad();
 
   std::cout << "Loaded TMX map: " << mapWidth << "x" << mapHeight << " tiles"
             << std::endl;
   std::cout << "Text objects found: " << textObjects.size() << std::endl;
+  if (!objects.empty()) {
+    std::cout << "Map objects found: " << objects.size() << std::endl;
+  }
+  if (!imageLayers.empty()) {
+    std::cout << "Image layers found: " << imageLayers.size() << std::endl;
+  }
 
   return !mainGrid.empty();
 }
 
-std::vector<std::vector<int>> Map::parseLayerData(const std::string &csvData,
-                                                  int width, int height) {
-  std::vector<std::vector<int>> grid;
-  std::stringstream ss(csvData);
-  std::string line;
+void Map::parseTileset(std::string_view content, std::uint32_t firstGid,
+                       const std::string &directory, bool &imageSeen) {
+  std::vector<TileTypes::Entry> entries;
+  bool hasImage = false;
+  std::string_view imageSource;
+  int tileWidth = static_cast<int>(TILE_SIZE);
+  int tileHeight = static_cast<int>(TILE_SIZE);
+  int columns = 1;
+  int spacing = 0;
+  int margin = 0;
+
+  // Tile being read: its local ID and the flags of its true properties
+  bool inTile = false;
+  bool tileImage = false; // Has its own image, not in the atlas
+  bool tileImagesDropped = false;
+  std::uint32_t id = 0;
+  std::uint8_t flags = 0;
+
+  size_t pos = 0;
+  while ((pos = content.find('<', pos)) != std::string_view::npos) {
+    if (content.compare(pos, 4, "<!--") == 0) {
+      size_t commentEnd = content.find("-->", pos + 4);
+      if (commentEnd == std::string_view::npos)
+        break;
+      pos = commentEnd + 3;
+      continue;
+    }
+
+    size_t tagEnd = content.find('>', pos);
+    if (tagEnd == std::string_view::npos)
+      break;
 
-  while (std::getline(ss, line)) {
-    // Skip empty lines
-    if (line.empty() || line.find_first_not_of(" \t\r\n") == std::string::npos)
+    std::string_view tag = content.substr(pos + 1, tagEnd - pos - 1);
+    pos = tagEnd + 1;
+    if (tag.empty() || tag[0] == '?' || tag[0] == '!')
       continue;
 
-    std::vector<int> row;
-    std::stringstream lineStream(line);
-    std::string cell;
-
-    while (std::getline(lineStream, cell, ',')) {
-      // Remove whitespace
-      cell.erase(std::remove_if(cell.begin(), cell.end(), ::isspace),
-                 cell.end());
-      if (!cell.empty()) {
-        try {
-          // Tiled uses 1-based IDs, 0 means empty
-          // Subtract 1 to get our 0-based IDs, but handle 0 specially
-          int rawId = std::stoi(cell);
-          int tileId = (rawId == 0) ? -1 : rawId - 1;
-          row.push_back(tileId);
-        } catch (...) {
-          row.push_back(-1);
+    std::string_view name = tagName(tag);
+    if (tag[0] == '/') {
+      if (name == "tile" && inTile) {
+        inTile = false;
+        if (tileImage && (flags & TileTypes::RENDER)) {
+          flags &= static_cast<std::uint8_t>(~TileTypes::RENDER);
+          tileImagesDropped = true;
         }
+        std::uint32_t gid = firstGid + id;
+        if (flags == 0 || gid > 0xFFFF)
+          continue; // Nothing to add, or beyond what TileIds can hold
+        int column = static_cast<int>(id) % columns;
+        int row = static_cast<int>(id) / columns;
+        entries.push_back(
+            {static_cast<TileGrid::TileId>(gid), flags,
+             sf::IntRect({margin + column * (tileWidth + spacing),
+                          margin + row * (tileHeight + spacing)},
+                         {tileWidth, tileHeight})});
       }
+      continue;
     }
 
-    if (!row.empty()) {
-      grid.push_back(row);
+    if (name == "tileset") {
+      parseNumber(extractAttribute(tag, "tilewidth"), tileWidth);
+      parseNumber(extractAttribute(tag, "tileheight"), tileHeight);
+      parseNumber(extractAttribute(tag, "columns"), columns);
+      parseNumber(extractAttribute(tag, "spacing"), spacing);
+      parseNumber(extractAttribute(tag, "margin"), margin);
+      columns = std::max(columns, 1);
+    } else if (name == "image") {
+      if (inTile) {
+        tileImage = true;
+      } else {
+        hasImage = true;
+        imageSource = extractAttribute(tag, "source");
+      }
+    } else if (name == "tile" && tag.back() != '/') {
+      inTile = parseNumber(extractAttribute(tag, "id"), id);
+      tileImage = false;
+      flags = 0;
+    } else if (name == "property" && inTile &&
+               extractAttribute(tag, "value") == "true") {
+      std::string_view property = extractAttribute(tag, "name");
+      if (property == "solid")
+        flags |= TileTypes::SOLID;
+      else if (property == "oneway")
+        flags |= TileTypes::ONE_WAY;
+      else if (property == "hazard")
+        flags |= TileTypes::HAZARD;
+      else if (property == "spawn")
+        flags |= TileTypes::SPAWN;
+      else if (property == "finish")
+        flags |= TileTypes::FINISH;
+      else if (property == "render")
+        flags |= TileTypes::RENDER;
     }
   }
 
-  return grid;
+  // The atlas only has TILESET_IMAGE, so tiles of any other image would
+  // be drawn with its pixels; they keep their other properties
+  const char *reason = nullptr;
+  if (!hasImage)
+    reason = "it has no tileset image";
+  else if (imageSeen)
+    reason = "only the map's first image tileset can be";
+  else if (!isTilesetImage(directory, imageSource))
+    reason = "its image isn't the atlas tileset image";
+  imageSeen = imageSeen || hasImage;
+
+  bool dropped = tileImagesDropped;
+  for (TileTypes::Entry &entry : entries) {
+    if (reason && (entry.flags & TileTypes::RENDER)) {
+      entry.flags &= static_cast<std::uint8_t>(~TileTypes::RENDER);
+      dropped = true;
+    }
+    tileTypes.add(entry);
+  }
+  if (dropped) {
+    std::cerr << "Warning: tiles of the tileset at firstgid " << firstGid
+              << " aren't drawn, "
+              << (reason ? reason : "they have their own images")
+              << std::endl;
+  }
 }
 
-void Map::parseObjectGroup(const std::string &content) {
-  size_t pos = 0;
+bool Map::parseBinary(std::string_view data) {
+  using namespace LevelFormat;
 
-  while (true) {
-    size_t objGroupStart = content.find("<objectgroup ", pos);
-    if (objGroupStart == std::string::npos)
-      break;
+  mainGrid.clear();
+  textureGrid.clear();
+  solidMask.clear();
+  textObjects.clear();
+  imageLayers.clear();
+  objects.clear();
+  mainRowHashes.clear();
+  textureRowHashes.clear();
+  streamer.reset();
+  tileTypes.clear();
+
+  // Validate the header and that every section lies inside the file
+  LevelHeader header;
+  if (data.size() < sizeof(header)) {
+    std::cerr << "Error: level file is truncated" << std::endl;
+    return false;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+
+  // Both dimensions must fit TileGrid's ints, which also keeps the layer
+  // size from overflowing before it is checked against the file
+  constexpr std::uint32_t maxDimension = std::numeric_limits<int>::max();
+  std::uint64_t layerBytes = std::uint64_t{header.width} * header.height *
+                             sizeof(TileGrid::TileId);
+  auto fits = [&](std::uint64_t offset, std::uint64_t bytes) {
+    return offset <= data.size() && bytes <= data.size() - offset;
+  };
+
+  if (!std::equal(header.magic, header.magic + 4, MAGIC) ||
+      header.version != VERSION) {
+    std::cerr << "Error: not a level file, or an unsupported version"
+              << std::endl;
+    return false;
+  }
+  if (header.width > maxDimension || header.height > maxDimension) {
+    std::cerr << "Error: level dimensions are out of range" << std::endl;
+    return false;
+  }
+  if (!fits(header.mainOffset, layerBytes) ||
+      !fits(header.textureOffset, layerBytes) ||
+      !fits(header.objectOffset,
+            std::uint64_t{header.objectCount} * sizeof(LevelObject)) ||
+      !fits(header.textOffset,
+            std::uint64_t{header.textCount} * sizeof(LevelText)) ||
+      !fits(header.imageLayerOffset,
+            std::uint64_t{header.imageLayerCount} * sizeof(LevelImageLayer)) ||
+      !fits(header.tileTypeOffset,
+            std::uint64_t{header.tileTypeCount} * sizeof(LevelTileType)) ||
+      !fits(header.stringOffset, header.stringSize)) {
+    std::cerr << "Error: level file is truncated" << std::endl;
+    return false;
+  }
 
-    size_t objGroupEnd = content.find("</objectgroup>", objGroupStart);
-    if (objGroupEnd == std::string::npos)
-      break;
+  // Tile layers are stored exactly as TileGrid keeps them
+  int width = static_cast<int>(header.width);
+  int height = static_cast<int>(header.height);
+  mainGrid.resize(width, height);
+  textureGrid.resize(width, height);
+  std::memcpy(mainGrid.data(), data.data() + header.mainOffset,
+              static_cast<size_t>(layerBytes));
+  std::memcpy(textureGrid.data(), data.data() + header.textureOffset,
+              static_cast<size_t>(layerBytes));
+
+  startPosition = {header.spawnX, header.spawnY};
+
+  for (std::uint32_t i = 0; i < header.tileTypeCount; ++i) {
+    LevelTileType entry;
+    std::memcpy(&entry,
+                data.data() + header.tileTypeOffset + i * sizeof(entry),
+                sizeof(entry));
+    tileTypes.add({entry.id, entry.flags,
+                   sf::IntRect({entry.sourceX, entry.sourceY},
+                               {entry.sourceWidth, entry.sourceHeight})});
+  }
 
-    std::string objGroupContent =
-        content.substr(objGroupStart, objGroupEnd - objGroupStart);
+  std::string_view strings =
+      data.substr(header.stringOffset, header.stringSize);
+  objects.reserve(header.objectCount);
+  for (std::uint32_t i = 0; i < header.objectCount; ++i) {
+    LevelObject entry;
+    std::memcpy(&entry, data.data() + header.objectOffset + i * sizeof(entry),
+                sizeof(entry));
+    if (entry.nameOffset + std::uint64_t{entry.nameLength} > strings.size() ||
+        entry.type > static_cast<std::uint32_t>(MapObjectType::KillZone)) {
+      std::cerr << "Error: level file has a bad object entry" << std::endl;
+      return false;
+    }
 
-    // Check if this is the text layer
-    size_t tagEnd = objGroupContent.find(">");
-    std::string groupTag = objGroupContent.substr(0, tagEnd);
-    std::string groupName = extractAttribute(groupTag, "name");
+    MapObject object;
+    object.type = static_cast<MapObjectType>(entry.type);
+    object.bounds = sf::FloatRect({entry.bounds.x, entry.bounds.y},
+                                  {entry.bounds.width, entry.bounds.height});
+    object.name = strings.substr(entry.nameOffset, entry.nameLength);
+    objects.push_back(std::move(object));
+  }
 
-    if (groupName == "text") {
-      // Parse each object in this group
-      size_t objPos = 0;
-      while (true) {
-        size_t objStart = objGroupContent.find("<object ", objPos);
-        if (objStart == std::string::npos)
-          break;
+  textObjects.reserve(header.textCount);
+  for (std::uint32_t i = 0; i < header.textCount; ++i) {
+    LevelText entry;
+    std::memcpy(&entry, data.data() + header.textOffset + i * sizeof(entry),
+                sizeof(entry));
+    if (entry.nameOffset + std::uint64_t{entry.nameLength} > strings.size() ||
+        entry.contentOffset + std::uint64_t{entry.contentLength} >
+            strings.size()) {
+      std::cerr << "Error: level file has a bad text entry" << std::endl;
+      return false;
+    }
 
-        size_t objEnd = objGroupContent.find("</object>", objStart);
-        if (objEnd == std::string::npos)
-          break;
+    MapText text;
+    text.position = {entry.bounds.x, entry.bounds.y};
+    text.size = {entry.bounds.width, entry.bounds.height};
+    text.name = strings.substr(entry.nameOffset, entry.nameLength);
+    text.content = strings.substr(entry.contentOffset, entry.contentLength);
+    textObjects.push_back(std::move(text));
+  }
 
-        std::string objContent =
-            objGroupContent.substr(objStart, objEnd - objStart);
-
-        // Extract object attributes
-        size_t objTagEnd = objContent.find(">");
-        std::string objTag = objContent.substr(0, objTagEnd);
-
-        MapText text;
-        text.name = extractAttribute(objTag, "name");
-
-        std::string xStr = extractAttribute(objTag, "x");
-        std::string yStr = extractAttribute(objTag, "y");
-        std::string wStr = extractAttribute(objTag, "width");
-        std::string hStr = extractAttribute(objTag, "height");
-
-        if (!xStr.empty())
-          text.position.x = std::stof(xStr);
-        if (!yStr.empty())
-          text.position.y = std::stof(yStr);
-        if (!wStr.empty())
-          text.size.x = std::stof(wStr);
-        if (!hStr.empty())
-          text.size.y = std::stof(hStr);
-
-        // Extract text content between <text> tags
-        size_t textStart = objContent.find("<text");
-        if (textStart != std::string::npos) {
-          size_t textContentStart = objContent.find(">", textStart) + 1;
-          size_t textContentEnd = objContent.find("</text>", textContentStart);
-          if (textContentEnd != std::string::npos) {
-            text.content = objContent.substr(textContentStart,
-                                             textContentEnd - textContentStart);
-          }
-        }
+  imageLayers.reserve(header.imageLayerCount);
+  for (std::uint32_t i = 0; i < header.imageLayerCount; ++i) {
+    LevelImageLayer entry;
+    std::memcpy(&entry,
+                data.data() + header.imageLayerOffset + i * sizeof(entry),
+                sizeof(entry));
+    if (entry.nameOffset + std::uint64_t{entry.nameLength} > strings.size() ||
+        entry.sourceOffset + std::uint64_t{entry.sourceLength} >
+            strings.size()) {
+      std::cerr << "Error: level file has a bad image layer entry"
+                << std::endl;
+      return false;
+    }
 
-        if (!text.content.empty()) {
-          textObjects.push_back(text);
-        }
+    ImageLayer layer;
+    layer.name = strings.substr(entry.nameOffset, entry.nameLength);
+    layer.source = strings.substr(entry.sourceOffset, entry.sourceLength);
+    layer.offset = {entry.offsetX, entry.offsetY};
+    layer.parallax = {entry.parallaxX, entry.parallaxY};
+    layer.scale = entry.scale;
+    layer.tint = sf::Color(entry.tint);
+    layer.repeatX = entry.flags & LevelImageLayer::REPEAT_X;
+    layer.repeatY = entry.flags & LevelImageLayer::REPEAT_Y;
+    imageLayers.push_back(std::move(layer));
+  }
 
-        objPos = objEnd + 9; // Move past </object>
-      }
+  finishLoad();
+
+  std::cout << "Loaded binary map: " << width << "x" << height << " tiles"
+            << std::endl;
+
+  return !mainGrid.empty();
+}
+
+bool Map::saveBinary(const std::string &filename) const {
+  using namespace LevelFormat;
+
+  if (streamer) {
+    std::cerr << "Error: streamed (infinite) maps can't be precompiled"
+              << std::endl;
+    return false;
+  }
+
+  // Image paths are stored relative to the level file, not the map
+  std::string outputDirectory =
+      std::filesystem::path(filename).parent_path().string();
+
+  // Strings are packed into one section referenced by offset
+  std::string strings;
+  std::vector<LevelText> texts;
+  texts.reserve(textObjects.size());
+  for (const auto &textObj : textObjects) {
+    LevelText entry;
+    entry.bounds = {textObj.position.x, textObj.position.y, textObj.size.x,
+                    textObj.size.y};
+    entry.nameOffset = static_cast<std::uint32_t>(strings.size());
+    entry.nameLength = static_cast<std::uint32_t>(textObj.name.size());
+    strings += textObj.name;
+    entry.contentOffset = static_cast<std::uint32_t>(strings.size());
+    entry.contentLength = static_cast<std::uint32_t>(textObj.content.size());
+    strings += textObj.content;
+    texts.push_back(entry);
+  }
+
+  std::vector<LevelImageLayer> layers;
+  layers.reserve(imageLayers.size());
+  for (const ImageLayer &layer : imageLayers) {
+    LevelImageLayer entry{};
+    entry.offsetX = layer.offset.x;
+    entry.offsetY = layer.offset.y;
+    entry.parallaxX = layer.parallax.x;
+    entry.parallaxY = layer.parallax.y;
+    entry.scale = layer.scale;
+    entry.tint = layer.tint.toInteger();
+    entry.flags = 0;
+    if (layer.repeatX)
+      entry.flags |= LevelImageLayer::REPEAT_X;
+    if (layer.repeatY)
+      entry.flags |= LevelImageLayer::REPEAT_Y;
+    entry.nameOffset = static_cast<std::uint32_t>(strings.size());
+    entry.nameLength = static_cast<std::uint32_t>(layer.name.size());
+    strings += layer.name;
+    std::string source = rebasePath(layer.source, directory, outputDirectory);
+    entry.sourceOffset = static_cast<std::uint32_t>(strings.size());
+    entry.sourceLength = static_cast<std::uint32_t>(source.size());
+    strings += source;
+    layers.push_back(entry);
+  }
+
+  std::vector<LevelTileType> types;
+  types.reserve(tileTypes.getEntries().size());
+  for (const TileTypes::Entry &type : tileTypes.getEntries()) {
+    types.push_back({type.id, type.flags, 0, type.source.position.x,
+                     type.source.position.y, type.source.size.x,
+                     type.source.size.y});
+  }
+
+  std::vector<LevelObject> objectEntries;
+  objectEntries.reserve(objects.size());
+  for (const MapObject &object : objects) {
+    LevelObject entry{};
+    entry.bounds = {object.bounds.position.x, object.bounds.position.y,
+                    object.bounds.size.x, object.bounds.size.y};
+    entry.type = static_cast<std::uint32_t>(object.type);
+    entry.nameOffset = static_cast<std::uint32_t>(strings.size());
+    entry.nameLength = static_cast<std::uint32_t>(object.name.size());
+    strings += object.name;
+    objectEntries.push_back(entry);
+  }
+
+  // Lay out the sections, each 8-byte aligned
+  auto align = [](std::uint64_t offset) { return (offset + 7) & ~7ull; };
+  size_t layerBytes = mainGrid.size() * sizeof(TileGrid::TileId);
+
+  LevelHeader header{};
+  std::copy(MAGIC, MAGIC + 4, header.magic);
+  header.version = VERSION;
+  header.width = static_cast<std::uint32_t>(mainGrid.getWidth());
+  header.height = static_cast<std::uint32_t>(mainGrid.getHeight());
+  header.spawnX = startPosition.x;
+  header.spawnY = startPosition.y;
+  header.objectCount = static_cast<std::uint32_t>(objectEntries.size());
+  header.textCount = static_cast<std::uint32_t>(texts.size());
+  header.imageLayerCount = static_cast<std::uint32_t>(layers.size());
+  header.tileTypeCount = static_cast<std::uint32_t>(types.size());
+  header.mainOffset = align(sizeof(header));
+  header.textureOffset = align(header.mainOffset + layerBytes);
+  header.objectOffset = align(header.textureOffset + layerBytes);
+  header.textOffset = align(header.objectOffset +
+                            objectEntries.size() * sizeof(LevelObject));
+  header.imageLayerOffset =
+      align(header.textOffset + texts.size() * sizeof(LevelText));
+  header.tileTypeOffset = align(header.imageLayerOffset +
+                                layers.size() * sizeof(LevelImageLayer));
+  header.stringOffset = align(header.tileTypeOffset +
+                              types.size() * sizeof(LevelTileType));
+  header.stringSize = strings.size();
+
+  // The texture layer must match the main layer's size in the file
+  TileGrid textures(mainGrid.getWidth(), mainGrid.getHeight());
+  for (int y = 0; y < textures.getHeight(); ++y) {
+    for (int x = 0; x < textures.getWidth(); ++x)
+      textures.setUnchecked(x, y, textureGrid.get(x, y));
+  }
+
+  std::vector<char> file(header.stringOffset + header.stringSize, 0);
+  std::memcpy(file.data(), &header, sizeof(header));
+  std::memcpy(file.data() + header.mainOffset, mainGrid.data(), layerBytes);
+  std::memcpy(file.data() + header.textureOffset, textures.data(),
+              layerBytes);
+  std::memcpy(file.data() + header.objectOffset, objectEntries.data(),
+              objectEntries.size() * sizeof(LevelObject));
+  std::memcpy(file.data() + header.textOffset, texts.data(),
+              texts.size() * sizeof(LevelText));
+  std::memcpy(file.data() + header.imageLayerOffset, layers.data(),
+              layers.size() * sizeof(LevelImageLayer));
+  std::memcpy(file.data() + header.tileTypeOffset, types.data(),
+              types.size() * sizeof(LevelTileType));
+  std::memcpy(file.data() + header.stringOffset, strings.data(),
+              strings.size());
+
+  std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+  if (!out.is_open()) {
+    std::cerr << "Failed to create level file: " << filename << std::endl;
+    return false;
+  }
+  out.write(file.data(), static_cast<std::streamsize>(file.size()));
+  return static_cast<bool>(out);
+}
+
+void Map::finishLoad() {
+  // Index the objects for the per-tick overlap queries
+  objectIndex.clear();
+  for (std::uint32_t i = 0; i < objects.size(); ++i)
+    objectIndex.insert(i, objects[i].bounds);
+  objectIndex.build();
+
+  if (tilesetTexture) {
+    tileRenderer.setTileset(tilesetTexture,
+                            tileTypes.getRenderRects(tilesetOrigin));
+  }
+
+  if (streamer) {
+    // Chunk meshes are swapped in as the streamer loads them
+    tileRenderer.resetStreamed(widthInTiles, heightInTiles, TILE_SIZE);
+    streamer->setTileset(tileRenderer.getTileRects(), TILE_SIZE);
+    return;
+  }
+  widthInTiles = mainGrid.getWidth();
+  heightInTiles = mainGrid.getHeight();
+
+  // Precompute wall bits for collision queries (on a reload, only where
+  // the main layer changed)
+  if (previousVersion &&
+      previousVersion->mainGrid.getWidth() == mainGrid.getWidth() &&
+      previousVersion->mainGrid.getHeight() == mainGrid.getHeight() &&
+      previousVersion->tileTypes == tileTypes) {
+    updateSolidMask(*previousVersion);
+  } else {
+    buildSolidMask();
+  }
+
+  // Lay out render chunks for the texture layer
+  tileRenderer.reset(textureGrid, TILE_SIZE);
+}
+
+void Map::prepareGraphics() {
+  // Prepare cached text objects (optimization: avoid allocation in render loop)
+  prepareTextObjects();
+
+  if (hasResources)
+    background.load(imageLayers, directory);
+}
+
+TileGrid Map::parseLayerData(std::string_view data, int width, int height,
+                             std::string_view encoding) {
+  TileGrid grid(width, height);
+
+  size_t written = decodeLayerData(data, grid.data(), grid.size(), encoding);
+  if (encoding != "csv" && encoding != "base64")
+    return grid; // Already reported
+
+  if (written < grid.size()) {
+    std::cerr << "Warning: layer data has " << written << " tiles, expected "
+              << grid.size() << std::endl;
+  }
+
+  return grid;
+}
+
+size_t Map::decodeLayerData(std::string_view data, TileGrid::TileId *tiles,
+                            size_t count, std::string_view encoding) {
+  if (encoding == "csv")
+    return decodeCSVParallel(data, tiles, count);
+  if (encoding == "base64")
+    return decodeBase64(data, tiles, count);
+  std::cerr << "Error: unsupported layer encoding \"" << encoding << "\""
+            << std::endl;
+  return 0;
+}
+
+bool Map::indexChunks(std::string_view content,
+                      const std::vector<ChunkEntry> &chunks,
+                      std::string_view mainEncoding,
+                      std::string_view texturesEncoding) {
+  constexpr int SIZE = ChunkStreamer::CHUNK_SIZE;
+  if (chunks.empty()) {
+    std::cerr << "Error: infinite map has no chunks" << std::endl;
+    return false;
+  }
+
+  // Bounds, in chunks. Chunks must line up with the render chunks, which
+  // Tiled's default chunk size does.
+  int minX = std::numeric_limits<int>::max();
+  int minY = std::numeric_limits<int>::max();
+  int maxX = std::numeric_limits<int>::min();
+  int maxY = std::numeric_limits<int>::min();
+  for (const ChunkEntry &chunk : chunks) {
+    if (chunk.width != SIZE || chunk.height != SIZE || chunk.x % SIZE != 0 ||
+        chunk.y % SIZE != 0) {
+      std::cerr << "Error: infinite map chunks must be " << SIZE << "x"
+                << SIZE << " tiles" << std::endl;
+      return false;
     }
+    minX = std::min(minX, chunk.x / SIZE);
+    minY = std::min(minY, chunk.y / SIZE);
+    maxX = std::max(maxX, chunk.x / SIZE);
+    maxY = std::max(maxY, chunk.y / SIZE);
+  }
+  int chunksX = maxX - minX + 1;
+  int chunksY = maxY - minY + 1;
+
+  std::vector<ChunkStreamer::Source> sources(static_cast<size_t>(chunksX) *
+                                             chunksY);
+  for (const ChunkEntry &chunk : chunks) {
+    ChunkStreamer::Source &source =
+        sources[static_cast<size_t>(chunk.y / SIZE - minY) * chunksX +
+                chunk.x / SIZE - minX];
+    ChunkStreamer::ChunkData &data =
+        chunk.textures ? source.textures : source.main;
+    data.offset = static_cast<std::uint64_t>(chunk.data.data() -
+                                              content.data());
+    data.length = static_cast<std::uint32_t>(chunk.data.size());
+  }
 
-    pos = objGroupEnd + 14; // Move past </objectgroup>
-  }
-}
-
-void Map::render(sf::RenderWindow &window) {
-  // Get the current view bounds for culling
-  sf::View view = window.getView();
-  sf::Vector2f viewCenter = view.getCenter();
-  sf::Vector2f viewSize = view.getSize();
-
-  // Calculate visible tile range (with 1 tile margin for safety)
-  int startX = std::max(
-      0, static_cast<int>((viewCenter.x - viewSize.x / 2.f) / TILE_SIZE) - 1);
-  int startY = std::max(
-      0, static_cast<int>((viewCenter.y - viewSize.y / 2.f) / TILE_SIZE) - 1);
-  int endX = std::min(
-      static_cast<int>(textureGrid.empty() ? 0 : textureGrid[0].size()),
-      static_cast<int>((viewCenter.x + viewSize.x / 2.f) / TILE_SIZE) + 2);
-  int endY = std::min(
-      static_cast<int>(textureGrid.size()),
-      static_cast<int>((viewCenter.y + viewSize.y / 2.f) / TILE_SIZE) + 2);
-
-  // Render only visible tiles (view culling optimization)
-  for (int y = startY; y < endY; ++y) {
-    for (int x = startX; x < endX; ++x) {
-      if (y >= 0 && y < static_cast<int>(textureGrid.size()) && x >= 0 &&
-          x < static_cast<int>(textureGrid[y].size())) {
-        int id = textureGrid[y][x];
-
-        // Skip empty tiles
-        if (id < 3 || id > 5)
-          continue;
-
-        tileShape.setPosition({static_cast<float>(x) * TILE_SIZE,
-                               static_cast<float>(y) * TILE_SIZE});
-
-        // Set texture based on tile type (switch is more efficient for multiple
-        // cases)
-        switch (id) {
-        case 5: // Wall texture
-          tileShape.setTexture(&wallTexture);
-          break;
-        case 4: // Finish texture
-          tileShape.setTexture(&finishTexture);
-          break;
-        case 3: // Spawn texture
-          tileShape.setTexture(&spawnTexture);
-          break;
-        default:
-          continue;
+  // The spawn, the finish and which chunks have walls need the whole main
+  // layer, so each chunk is decoded once, in parallel, into scratch space.
+  // Only the few chunks with a spawn or finish are decoded again below.
+  std::vector<std::uint8_t> markers(sources.size(), 0);
+  constexpr std::uint8_t SPAWN = 1, FINISH = 2;
+  JobSystem::instance().parallelForWait(
+      sources.size(), 256, [&](size_t begin, size_t end) {
+        TileGrid::TileId tiles[SIZE * SIZE];
+        for (size_t i = begin; i < end; ++i) {
+          const ChunkStreamer::ChunkData &data = sources[i].main;
+          if (data.length == 0)
+            continue;
+          size_t count = decodeLayerData(
+              content.substr(data.offset, data.length), tiles,
+              SIZE * SIZE, mainEncoding);
+          for (size_t t = 0; t < count; ++t) {
+            std::uint8_t flags = tileTypes.get(tiles[t]);
+            if (flags & (TileTypes::SOLID | TileTypes::ONE_WAY))
+              sources[i].hasWalls = true;
+            if (flags & TileTypes::SPAWN)
+              markers[i] |= SPAWN;
+            else if (flags & TileTypes::FINISH)
+              markers[i] |= FINISH;
+          }
         }
-        tileShape.setFillColor(sf::Color::White);
-        window.draw(tileShape);
+      });
+
+  // Objects were placed in Tiled's coordinates; move them with the tiles
+  sf::Vector2f shift(-minX * SIZE * TILE_SIZE, -minY * SIZE * TILE_SIZE);
+  for (MapText &text : textObjects)
+    text.position += shift;
+  for (MapObject &object : objects)
+    object.bounds.position += shift;
+  for (ImageLayer &layer : imageLayers)
+    layer.offset += shift;
+
+  int spawnCount = 0;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    if (markers[i] == 0)
+      continue;
+    const ChunkStreamer::ChunkData &data = sources[i].main;
+    TileGrid::TileId tiles[SIZE * SIZE] = {};
+    decodeLayerData(content.substr(data.offset, data.length), tiles,
+                    SIZE * SIZE, mainEncoding);
+    int originX = static_cast<int>(i % chunksX) * SIZE;
+    int originY = static_cast<int>(i / chunksX) * SIZE;
+    for (int t = 0; t < SIZE * SIZE; ++t) {
+      sf::Vector2f corner((originX + t % SIZE) * TILE_SIZE,
+                          (originY + t / SIZE) * TILE_SIZE);
+      std::uint8_t flags = tileTypes.get(tiles[t]);
+      if (flags & TileTypes::SPAWN) {
+        if (spawnCount++ > 0)
+          std::cerr << "Warning: Multiple spawn points found!" << std::endl;
+        startPosition = corner + sf::Vector2f(TILE_SIZE, TILE_SIZE) / 2.f;
+      } else if (flags & TileTypes::FINISH) {
+        objects.push_back({MapObjectType::Finish,
+                           sf::FloatRect(corner, {TILE_SIZE, TILE_SIZE}),
+                           {}});
       }
     }
   }
 
-  // Render cached text objects (no allocation in render loop)
-  for (auto &text : cachedTexts) {
-    window.draw(text);
+  widthInTiles = chunksX * SIZE;
+  heightInTiles = chunksY * SIZE;
+  streamer = std::make_unique<ChunkStreamer>(chunksX, chunksY,
+                                             std::move(sources), mainEncoding,
+                                             texturesEncoding, tileTypes,
+                                             streamSettings);
+  finishLoad();
+  return true;
+}
+
+void Map::render(sf::RenderWindow &window, const sf::IntRect &chunks) {
+  PROFILE_ZONE("Map::render");
+  // Draw the chunk meshes overlapping the view (one draw call per chunk).
+  // Streamed meshes are swapped between ticks, but not mid-draw.
+  if (streamer) {
+    std::shared_lock<std::shared_mutex> lock(streamer->getMeshMutex());
+    tileRenderer.render(window, textureGrid, chunks);
+  } else {
+    tileRenderer.render(window, textureGrid, chunks);
+  }
+
+  // Text objects in view, gathered into one batch. The set seldom
+  // changes from one frame to the next, so it's only regathered then.
+  const sf::View &view = window.getView();
+  sf::FloatRect viewBounds(view.getCenter() - view.getSize() / 2.f,
+                           view.getSize());
+  visibleTexts.clear();
+  textIndex.query(viewBounds,
+                  [&](std::uint32_t index) { visibleTexts.push_back(index); });
+  std::sort(visibleTexts.begin(), visibleTexts.end());
+  if (visibleTexts != drawnTexts) {
+    visibleText.clear();
+    for (std::uint32_t index : visibleTexts)
+      visibleText.append(textBatches[index]);
+    drawnTexts.swap(visibleTexts);
   }
+  visibleText.draw(window);
 }
 
-// Prepare text objects once (called after map loading)
+void Map::setTextureTile(int x, int y, TileGrid::TileId id) {
+  if (!textureGrid.inBounds(x, y) || textureGrid.getUnchecked(x, y) == id)
+    return;
+  textureGrid.setUnchecked(x, y, id);
+  tileRenderer.markDirty(x, y);
+}
+
+// Lay out text objects once (called after map loading). Wrapping uses
+// cached glyph advances, so it is one pass over each text.
 void Map::prepareTextObjects() {
-  cachedTexts.clear();
+  textBatches.clear();
+  textIndex.clear();
+  visibleText.clear();
+  drawnTexts.clear();
 
-  if (!fontLoaded)
+  if (!font)
     return;
 
-  // Reserve space to avoid reallocations
-  cachedTexts.reserve(textObjects.size());
-
-  for (const auto &textObj : textObjects) {
-    sf::Text text(font);
-    text.setCharacterSize(12);
-    text.setFillColor(sf::Color::White);
-    text.setOutlineColor(sf::Color::Black);
-    text.setOutlineThickness(1.f);
-
-    // Manual word wrap based on object width from Tiled
-    std::string wrappedText;
-    std::string currentLine;
-    std::string word;
+  textGlyphs.emplace(*font, 12, 1.f);
+  textBatches.resize(textObjects.size());
+  for (std::uint32_t i = 0; i < textObjects.size(); ++i) {
+    const MapText &textObj = textObjects[i];
+    // Wrap to the object width from Tiled
     float maxWidth = textObj.size.x > 0 ? textObj.size.x : 100.f;
+    sf::Vector2f size = textBatches[i].append(
+        *textGlyphs, textObj.content, textObj.position, sf::Color::White,
+        sf::Color::Black, maxWidth);
+
+    // Indexed by what was laid out, which may overflow the Tiled box;
+    // the margin covers the outline and glyphs reaching past the pen
+    sf::Vector2f margin(4.f, 4.f);
+    textIndex.insert(
+        i, sf::FloatRect(textObj.position - margin, size + margin * 2.f));
+  }
+  textIndex.build();
+}
 
-    for (size_t i = 0; i <= textObj.content.size(); ++i) {
-      char c = (i < textObj.content.size()) ? textObj.content[i] : ' ';
-
-      if (c == ' ' || c == '\n' || i == textObj.content.size()) {
-        std::string testLine =
-            currentLine.empty() ? word : currentLine + " " + word;
-        text.setString(testLine);
-        float lineWidth = text.getLocalBounds().size.x;
-
-        if (lineWidth > maxWidth && !currentLine.empty()) {
-          if (!wrappedText.empty())
-            wrappedText += "\n";
-          wrappedText += currentLine;
-          currentLine = word;
-        } else {
-          currentLine = testLine;
-        }
-        word.clear();
+bool Map::tileRange(const sf::FloatRect &bounds, int &left, int &top,
+                    int &right, int &bottom) const {
+  // Calculate tile range to check
+  left = static_cast<int>(bounds.position.x / TILE_SIZE);
+  top = static_cast<int>(bounds.position.y / TILE_SIZE);
+  right = static_cast<int>((bounds.position.x + bounds.size.x) / TILE_SIZE);
+  bottom = static_cast<int>((bounds.position.y + bounds.size.y) / TILE_SIZE);
 
-        if (c == '\n') {
-          if (!wrappedText.empty())
-            wrappedText += "\n";
-          wrappedText += currentLine;
-          currentLine.clear();
-        }
-      } else {
-        word += c;
-      }
-    }
+  // Clamp to map bounds
+  left = std::max(left, 0);
+  top = std::max(top, 0);
+  right = std::min(right, widthInTiles - 1);
+  bottom = std::min(bottom, heightInTiles - 1);
 
-    if (!currentLine.empty()) {
-      if (!wrappedText.empty())
-        wrappedText += "\n";
-      wrappedText += currentLine;
-    }
+  return left <= right && top <= bottom;
+}
 
-    text.setString(wrappedText);
-    text.setPosition(textObj.position);
-    cachedTexts.push_back(std::move(text));
-  }
+void Map::buildSolidMask() {
+  solidMask.assign((mainGrid.size() + 63) / 64, 0);
+
+  // Each job fills whole words, so no two write the same one
+  const TileGrid::TileId *tiles = mainGrid.data();
+  const size_t tileCount = mainGrid.size();
+  JobSystem::instance().parallelForWait(
+      solidMask.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t word = begin; word < end; ++word) {
+          size_t first = word * 64;
+          size_t last = std::min(first + 64, tileCount);
+          solidMask[word] = solidBits(tileTypes, tiles, first, last);
+        }
+      });
+}
+
+void Map::updateSolidMask(const Map &previous) {
+  solidMask = previous.solidMask;
+
+  // Comparing 64 tiles is far cheaper than classifying them, so only the
+  // words whose tiles changed pay for it
+  const TileGrid::TileId *tiles = mainGrid.data();
+  const TileGrid::TileId *oldTiles = previous.mainGrid.data();
+  const size_t tileCount = mainGrid.size();
+  JobSystem::instance().parallelForWait(
+      solidMask.size(), 4096, [&](size_t begin, size_t end) {
+        for (size_t word = begin; word < end; ++word) {
+          size_t first = word * 64;
+          size_t last = std::min(first + 64, tileCount);
+          if (std::memcmp(tiles + first, oldTiles + first,
+                          (last - first) * sizeof(TileGrid::TileId)) != 0)
+            solidMask[word] = solidBits(tileTypes, tiles, first, last);
+        }
+      });
 }
 
 std::vector<sf::FloatRect>
 Map::checkCollision(const sf::FloatRect &bounds) const {
+  PROFILE_ZONE("Map::checkCollision");
   std::vector<sf::FloatRect> collisions;
+  forEachSolid(bounds, [&](const sf::FloatRect &wall) {
+    collisions.push_back(wall);
+  });
+  return collisions;
+}
 
-  // Calculate tile range to check
-  int left_tile = static_cast<int>(bounds.position.x / TILE_SIZE);
-  int top_tile = static_cast<int>(bounds.position.y / TILE_SIZE);
-  int right_tile =
-      static_cast<int>((bounds.position.x + bounds.size.x) / TILE_SIZE);
-  int bottom_tile =
-      static_cast<int>((bounds.position.y + bounds.size.y) / TILE_SIZE);
+size_t Map::checkCollision(const sf::FloatRect &bounds,
+                           std::span<sf::FloatRect> out) const {
+  PROFILE_ZONE("Map::checkCollision");
+  size_t count = 0;
+  forEachSolid(bounds, [&](const sf::FloatRect &wall) {
+    if (count == out.size())
+      return false;
+    out[count++] = wall;
+    return true;
+  });
+  return count;
+}
 
-  // Clamp to map bounds
-  if (left_tile < 0)
-    left_tile = 0;
-  if (top_tile < 0)
-    top_tile = 0;
-  if (mainGrid.empty())
-    return collisions;
-  if (right_tile >= static_cast<int>(mainGrid[0].size()))
-    right_tile = static_cast<int>(mainGrid[0].size()) - 1;
-  if (bottom_tile >= static_cast<int>(mainGrid.size()))
-    bottom_tile = static_cast<int>(mainGrid.size()) - 1;
-
-  for (int y = top_tile; y <= bottom_tile; ++y) {
-    for (int x = left_tile; x <= right_tile; ++x) {
-      if (y >= 0 && y < mainGrid.size() && x >= 0 && x < mainGrid[y].size()) {
-        // Main layer ID 2 = wall (after -1 adjustment from Tiled's 3)
-        if (mainGrid[y][x] == 2) {
-          collisions.push_back(sf::FloatRect({x * TILE_SIZE, y * TILE_SIZE},
-                                             {TILE_SIZE, TILE_SIZE}));
+Map::SweepHit Map::sweepAABB(const sf::FloatRect &bounds,
+                             sf::Vector2f delta) const {
+  // Tolerance (in tiles) for edges that sit on a tile boundary up to
+  // float error, so they neither block nor get skipped
+  constexpr float EPSILON = 1e-4f;
+  constexpr float NEVER = std::numeric_limits<float>::infinity();
+
+  SweepHit result;
+  result.position = bounds.position + delta;
+
+  int stepX = delta.x > 0.f ? 1 : (delta.x < 0.f ? -1 : 0);
+  int stepY = delta.y > 0.f ? 1 : (delta.y < 0.f ? -1 : 0);
+  if (stepX == 0 && stepY == 0)
+    return result;
+
+  float left = bounds.position.x / TILE_SIZE;
+  float top = bounds.position.y / TILE_SIZE;
+  float right = left + bounds.size.x / TILE_SIZE;
+  float bottom = top + bounds.size.y / TILE_SIZE;
+  sf::Vector2f move = delta / TILE_SIZE;
+
+  // Next column/row the leading edges enter, and when (as a fraction of
+  // delta); the boundary entered is the near side of that column/row
+  int column = stepX > 0 ? static_cast<int>(std::ceil(right - EPSILON))
+                         : static_cast<int>(std::floor(left + EPSILON)) - 1;
+  int row = stepY > 0 ? static_cast<int>(std::ceil(bottom - EPSILON))
+                      : static_cast<int>(std::floor(top + EPSILON)) - 1;
+  float nextX = stepX == 0 ? NEVER
+                : stepX > 0 ? (column - right) / move.x
+                            : (column + 1 - left) / move.x;
+  float nextY = stepY == 0 ? NEVER
+                : stepY > 0 ? (row - bottom) / move.y
+                            : (row + 1 - top) / move.y;
+  float stepTimeX = stepX == 0 ? NEVER : 1.f / std::abs(move.x);
+  float stepTimeY = stepY == 0 ? NEVER : 1.f / std::abs(move.y);
+
+  // Range of cells strictly overlapped by [low, high), clamped to size
+  auto span = [](float low, float high, int size, int &first, int &last) {
+    first = std::max(static_cast<int>(std::floor(low + EPSILON)), 0);
+    last = std::min(static_cast<int>(std::ceil(high - EPSILON)) - 1, size - 1);
+  };
+
+  while (std::min(nextX, nextY) <= 1.f) {
+    if (nextX <= nextY) {
+      // Leading vertical edge enters a new column
+      float t = std::max(nextX, 0.f);
+      int first, last;
+      span(top + move.y * t, bottom + move.y * t, heightInTiles, first, last);
+      if (column >= 0 && column < widthInTiles) {
+        for (int y = first; y <= last; ++y) {
+          if (!isSolidUnchecked(column, y))
+            continue;
+          result.hit = true;
+          result.time = t;
+          result.normal = {static_cast<float>(-stepX), 0.f};
+          result.position = bounds.position + delta * t;
+          // Snap exactly onto the wall so the next sweep starts clean
+          result.position.x = stepX > 0
+                                  ? column * TILE_SIZE - bounds.size.x
+                                  : (column + 1) * TILE_SIZE;
+          return result;
         }
       }
+      column += stepX;
+      nextX += stepTimeX;
+    } else {
+      // Leading horizontal edge enters a new row
+      float t = std::max(nextY, 0.f);
+      int first, last;
+      span(left + move.x * t, right + move.x * t, widthInTiles, first, last);
+      if (row >= 0 && row < heightInTiles) {
+        for (int x = first; x <= last; ++x) {
+          // One-way tiles only stop what comes down onto their top
+          if (!isSolidUnchecked(x, row) &&
+              !(stepY > 0 &&
+                tileTypes.has(mainTile(x, row), TileTypes::ONE_WAY)))
+            continue;
+          result.hit = true;
+          result.time = t;
+          result.normal = {0.f, static_cast<float>(-stepY)};
+          result.position = bounds.position + delta * t;
+          result.position.y = stepY > 0 ? row * TILE_SIZE - bounds.size.y
+                                        : (row + 1) * TILE_SIZE;
+          return result;
+        }
+      }
+      row += stepY;
+      nextY += stepTimeY;
     }
   }
+  return result;
+}
 
-  return collisions;
+bool Map::overlapsSolid(const sf::FloatRect &bounds) const {
+  int left, top, right, bottom;
+  if (!tileRange(bounds, left, top, right, bottom))
+    return false;
+
+  for (int y = top; y <= bottom; ++y) {
+    for (int x = left; x <= right; ++x) {
+      if (isSolidUnchecked(x, y))
+        return true;
+    }
+  }
+  return false;
 }
 
-bool Map::checkFinish(const sf::FloatRect &bounds) const {
-  for (const auto &finishArea : finishAreas) {
-    if (bounds.findIntersection(finishArea).has_value()) {
-      return true;
+bool Map::checkHazard(const sf::FloatRect &bounds) const {
+  int left, top, right, bottom;
+  if (!tileRange(bounds, left, top, right, bottom))
+    return false;
+
+  for (int y = top; y <= bottom; ++y) {
+    for (int x = left; x <= right; ++x) {
+      if (tileTypes.has(mainTile(x, y), TileTypes::HAZARD))
+        return true;
     }
   }
   return false;
 }
+
+bool Map::checkFinish(const sf::FloatRect &bounds) const {
+  bool finished = false;
+  forEachObject(bounds, [&](const MapObject &object) {
+    finished = object.type == MapObjectType::Finish;
+    return !finished;
+  });
+  return finished;
+}
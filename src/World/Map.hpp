@@ -1,8 +1,24 @@
 #pragma once
+#include "../Graphics/ParallaxBackground.hpp"
+#include "../Graphics/TextLayout.hpp"
+#include "ChunkStreamer.hpp"
+#include "SpatialHash.hpp"
+#include "TileGrid.hpp"
+#include "TileRenderer.hpp"
+#include "TileTypes.hpp"
 #include <SFML/Graphics.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
+class TextureAtlas;
+
 // Structure for text objects from Tiled object layer
 struct MapText {
   sf::Vector2f position;
@@ -11,72 +27,351 @@ struct MapText {
   std::string name;
 };
 
+// What an object from a Tiled object layer does, from its class (or type)
+// or else the name of its layer. Values are stored in .lvl files.
+enum class MapObjectType : std::uint8_t {
+  Trigger = 0,    // Named area for game code to react to
+  Finish = 1,     // Ends the level (finish tiles become these too)
+  Checkpoint = 2, // Where the player comes back after dying
+  KillZone = 3,   // Sends the player back, like falling off the map
+};
+
+struct MapObject {
+  MapObjectType type;
+  sf::FloatRect bounds;
+  std::string name;
+};
+
 class Map {
 public:
   // Tile size: 32px
   static constexpr float TILE_SIZE = 32.f;
+  // The tileset image packed into the atlas as "tileset"; only tilesets
+  // using it (found by path, whatever the folder assets is in) are drawn
+  static constexpr const char *TILESET_IMAGE = "assets/tilesets/tileset.png";
+
+  // Takes the tileset image from the atlas and loads the font used for
+  // drawing. Headless simulation skips this; collision and logic work
+  // without it.
+  void loadResources(const TextureAtlas &atlas);
 
-  Map();
+  // How infinite maps are streamed; takes effect at the next load
+  void setStreamSettings(const StreamSettings &settings) {
+    streamSettings = settings;
+  }
 
-  // Loads map from a TMX file (Tiled format)
+  // Loads map from a TMX file (Tiled format) or a precompiled .lvl file.
+  // Same as loadData() followed by prepareGraphics().
   bool loadFromFile(const std::string &filename);
 
-  // Getters for map dimensions (in pixels)
-  float getWidth() const {
-    return mainGrid.empty() ? 0.f : mainGrid[0].size() * TILE_SIZE;
+  // CPU side of loading: reads and parses the file and builds collision data.
+  // Touches no GPU or font state, so it can run on a worker thread.
+  // progress (optional) is advanced from 0 to 1 while parsing.
+  // previous (optional) is an earlier load of the same file: CSV rows
+  // whose text didn't change are copied from it instead of decoded, and
+  // only the changed parts of the collision mask are rebuilt. It is only
+  // read, so it may still be in use elsewhere.
+  bool loadData(const std::string &filename,
+                std::atomic<float> *progress = nullptr,
+                const Map *previous = nullptr);
+
+  // Builds all tile meshes up front instead of on first draw (CPU only)
+  void buildTileMeshes() { tileRenderer.buildAll(textureGrid); }
+
+  // Copies the meshes of chunks whose tiles match previous, leaving only
+  // the changed ones for buildTileMeshes(). Reads previous's meshes, so
+  // call it on the thread that draws previous. Returns the chunks reused.
+  size_t reuseTileMeshes(const Map &previous) {
+    if (streamer || previous.streamer)
+      return 0;
+    return tileRenderer.reuseUnchanged(previous.tileRenderer,
+                                       previous.textureGrid, textureGrid);
   }
-  float getHeight() const { return mainGrid.size() * TILE_SIZE; }
+
+  // Infinite maps (Tiled <chunk>s) keep only the chunks around the camera
+  // loaded, streamed in the background. Call updateStreaming() once per
+  // tick, on the thread that makes the collision queries.
+  bool isStreamed() const { return streamer != nullptr; }
+  void updateStreaming(const sf::View &view);
+
+  // Main-thread side of loading: lays out the text objects (which uploads
+  // glyphs to the font texture) and loads the background images. Call
+  // after loadData() and loadResources().
+  void prepareGraphics();
+
+  // Writes the loaded map as a precompiled .lvl file (see LevelFormat.hpp).
+  // Streamed maps can't be precompiled.
+  bool saveBinary(const std::string &filename) const;
+
+  // Paths of the external .tsx tilesets a TMX file references; a .lvl
+  // compiled from it is stale once any of them is newer
+  static std::vector<std::string> findTilesetFiles(const std::string &tmx);
+
+  // Loads map from TMX content already in memory
+  bool loadFromMemory(std::string_view content) {
+    bool loaded = parseTMX(content);
+    prepareGraphics();
+    return loaded;
+  }
+
+  // Decodes a layer's <data> content ("csv" or uncompressed "base64")
+  static TileGrid parseLayerData(std::string_view data, int width, int height,
+                                 std::string_view encoding = "csv");
+
+  // Same, straight into count tiles. Returns the number written.
+  static size_t decodeLayerData(std::string_view data,
+                                TileGrid::TileId *tiles, size_t count,
+                                std::string_view encoding = "csv");
+
+  // Getters for map dimensions (in pixels)
+  float getWidth() const { return widthInTiles * TILE_SIZE; }
+  float getHeight() const { return heightInTiles * TILE_SIZE; }
 
   // Returns the player spawn position extracted from the map file
   sf::Vector2f getStartPosition() const { return startPosition; }
 
+  // Tile flags from the map's tilesets
+  const TileTypes &getTileTypes() const { return tileTypes; }
+
+  // Draws the image layers for the view (behind everything else)
+  void renderBackground(sf::RenderTarget &target, const sf::View &view) {
+    background.draw(target, view);
+  }
+
+  const std::vector<ImageLayer> &getImageLayers() const {
+    return imageLayers;
+  }
+
   // Renders only the visible portion of the map (view culling)
-  void render(sf::RenderWindow &window);
+  void render(sf::RenderWindow &window) {
+    render(window, getVisibleChunks(window.getView()));
+  }
+
+  // Renders the given chunk range (from getVisibleChunks)
+  void render(sf::RenderWindow &window, const sf::IntRect &chunks);
+
+  // Chunk range the renderer would draw for this view
+  sf::IntRect getVisibleChunks(const sf::View &view) const {
+    return tileRenderer.getVisibleChunks(view);
+  }
+
+  // Changes a tile of the "textures" layer; only its chunk mesh is rebuilt
+  void setTextureTile(int x, int y, TileGrid::TileId id);
 
   // Checks for collisions between an entity's bounding box and the map walls.
   std::vector<sf::FloatRect> checkCollision(const sf::FloatRect &bounds) const;
 
-  // Checks if the player bounds intersect with the finish tile
+  // Allocation-free variant: writes up to out.size() wall rects into out and
+  // returns how many were written
+  size_t checkCollision(const sf::FloatRect &bounds,
+                        std::span<sf::FloatRect> out) const;
+
+  // Returns true if the bounds touch any wall tile (no allocation)
+  bool overlapsSolid(const sf::FloatRect &bounds) const;
+
+  struct SweepHit {
+    bool hit = false;
+    float time = 1.f;      // Fraction of delta travelled before contact
+    sf::Vector2f position; // Top-left of the box at contact (or at the end)
+    sf::Vector2f normal;   // Wall normal at contact, e.g. (0, -1) = floor
+  };
+
+  // Moves bounds by delta through the wall grid and stops at the first
+  // wall. Only the tiles entered by the box's leading edges are visited,
+  // in order (grid DDA), so it can't tunnel at any speed. Tiles the box
+  // already overlaps or merely touches don't block, so a box resting on
+  // a floor slides along it freely.
+  SweepHit sweepAABB(const sf::FloatRect &bounds, sf::Vector2f delta) const;
+
+  // Calls visit(const sf::FloatRect &wall) for every wall tile touching the
+  // bounds, in row-major order. Return false from visit to stop early.
+  template <typename Visitor>
+  void forEachSolid(const sf::FloatRect &bounds, Visitor &&visit) const;
+
+  // Solidity of a single tile (out of range tiles are not solid)
+  bool isSolid(int x, int y) const {
+    return x >= 0 && y >= 0 && x < widthInTiles && y < heightInTiles &&
+           isSolidUnchecked(x, y);
+  }
+
+  // Something to stand on: a solid or one-way tile
+  bool isGround(int x, int y) const {
+    return isSolid(x, y) ||
+           (x >= 0 && y >= 0 && x < widthInTiles && y < heightInTiles &&
+            tileTypes.has(mainTile(x, y), TileTypes::ONE_WAY));
+  }
+
+  // Calls visit(const MapObject &) for every object overlapping the
+  // bounds. Goes through a spatial hash, so the cost follows the objects
+  // near the bounds, not the level's total. Return false from visit to
+  // stop early.
+  template <typename Visitor>
+  void forEachObject(const sf::FloatRect &bounds, Visitor &&visit) const {
+    objectIndex.query(bounds, [&](std::uint32_t index) {
+      return visit(objects[index]);
+    });
+  }
+
+  const std::vector<MapObject> &getObjects() const { return objects; }
+
+  // Checks if the player bounds intersect with a finish tile or area
   bool checkFinish(const sf::FloatRect &bounds) const;
 
+  // Checks if the bounds touch a hazard tile
+  bool checkHazard(const sf::FloatRect &bounds) const;
+
 private:
-  // Parse TMX XML content
-  bool parseTMX(const std::string &content);
+  // Parse TMX XML content in a single pass over the tags
+  bool parseTMX(std::string_view content);
+
+  // Load a precompiled .lvl file (no parsing, only copies)
+  bool parseBinary(std::string_view data);
+
+  // One layer's <chunk> of an infinite map, found by parseTMX()
+  struct ChunkEntry {
+    bool textures; // Else the main layer
+    int x, y, width, height; // In tiles
+    std::string_view data;
+  };
+
+  // Adds the tile properties of a tileset (the <tileset> element and its
+  // content, from the map or a .tsx file in directory) to tileTypes. Only
+  // the first tileset with an image (imageSeen is set once one is parsed)
+  // is drawn, and only if that image is TILESET_IMAGE
+  void parseTileset(std::string_view content, std::uint32_t firstGid,
+                    const std::string &directory, bool &imageSeen);
+
+  // Sets up streaming for an infinite map from its chunks. Tile (0, 0)
+  // becomes the top-left corner of the top-left chunk.
+  bool indexChunks(std::string_view content,
+                   const std::vector<ChunkEntry> &chunks,
+                   std::string_view mainEncoding,
+                   std::string_view texturesEncoding);
+
+  // Derived data shared by both loaders (collision mask, tile meshes)
+  void finishLoad();
+
+  // Tile range touched by the bounds, clamped to the map.
+  // Returns false if the range is empty.
+  bool tileRange(const sf::FloatRect &bounds, int &left, int &top, int &right,
+                 int &bottom) const;
+
+  TileGrid::TileId mainTile(int x, int y) const {
+    return streamer ? streamer->getTile(x, y) : mainGrid.getUnchecked(x, y);
+  }
 
-  // Parse a single layer's CSV data
-  std::vector<std::vector<int>> parseLayerData(const std::string &csvData,
-                                               int width, int height);
+  bool isSolidUnchecked(int x, int y) const {
+    if (streamer)
+      return streamer->isSolid(x, y);
+    size_t index = static_cast<size_t>(y) * mainGrid.getWidth() + x;
+    return (solidMask[index >> 6] >> (index & 63)) & 1u;
+  }
+
+  // Rebuilds solidMask from mainGrid and tileTypes
+  void buildSolidMask();
+
+  // Same, starting from previous's mask and redoing only the words whose
+  // tiles differ (the grids must be the same size, the tile types equal)
+  void updateSolidMask(const Map &previous);
 
-  // Parse object group for text objects
-  void parseObjectGroup(const std::string &content);
+  // Cell size of the object indexes; several objects' worth, since they
+  // are sparse and views span dozens of tiles
+  static constexpr int OBJECT_CELL_TILES = 8;
 
   // Prepare cached text objects for rendering (called after parsing)
   void prepareTextObjects();
 
   // Main grid for collision detection (from "main" layer)
-  std::vector<std::vector<int>> mainGrid;
+  TileGrid mainGrid;
 
   // Texture grid for rendering (from "textures" layer)
-  std::vector<std::vector<int>> textureGrid;
+  TileGrid textureGrid;
+
+  // Size in tiles (of the grids, or of the streamed map)
+  int widthInTiles = 0;
+  int heightInTiles = 0;
+
+  // Infinite maps only: the grids stay empty and the chunks around the
+  // camera are kept loaded instead
+  StreamSettings streamSettings;
+  std::unique_ptr<ChunkStreamer> streamer;
+
+  // What each tile ID does, from the tileset properties
+  TileTypes tileTypes;
+
+  // One bit per main grid tile, set for SOLID tiles (row-major like the
+  // grid)
+  std::vector<std::uint64_t> solidMask;
 
   // Text objects from object layer (raw data)
   std::vector<MapText> textObjects;
 
-  // Cached sf::Text objects for rendering (avoid allocation in render loop)
-  std::vector<sf::Text> cachedTexts;
+  // Every text object laid out into its own batch, indexed by where it
+  // ended up. Those in view are gathered into visibleText and drawn in one
+  // go; drawnTexts is the set it holds, so it's only redone on a change.
+  std::optional<GlyphCache> textGlyphs;
+  std::vector<TextBatch> textBatches;
+  SpatialHash textIndex{OBJECT_CELL_TILES};
+  TextBatch visibleText;
+  std::vector<std::uint32_t> visibleTexts; // Render scratch
+  std::vector<std::uint32_t> drawnTexts;
+
+  // Image layers (raw data) and the background drawn from them
+  std::vector<ImageLayer> imageLayers;
+  ParallaxBackground background;
+
+  // Folder of the loaded file; image sources are relative to it
+  std::string directory;
 
   sf::Vector2f startPosition{100.f, 100.f};
-  std::vector<sf::FloatRect> finishAreas;
 
-  // Reusable tile shape (avoid creating new shapes)
-  sf::RectangleShape tileShape;
+  // Triggers, finish areas, checkpoints and kill zones, and their index
+  std::vector<MapObject> objects;
+  SpatialHash objectIndex{OBJECT_CELL_TILES};
 
-  // Textures for tiles
-  sf::Texture finishTexture;
-  sf::Texture spawnTexture;
-  sf::Texture wallTexture;
+  // Tileset atlas and chunked renderer for the texture layer. The RENDER
+  // tiles' rects are set from tileTypes once the map is parsed.
+  TileRenderer tileRenderer;
+  const sf::Texture *tilesetTexture = nullptr;
+  sf::Vector2i tilesetOrigin; // Of the tileset image in the atlas
+
+  // Load progress of the current loadData() call (may be null)
+  std::atomic<float> *loadProgress = nullptr;
+
+  // Earlier version passed to the current loadData() call (may be null)
+  const Map *previousVersion = nullptr;
+
+  // Fingerprint of each row's CSV text, per layer (empty for other
+  // encodings and .lvl files)
+  std::vector<std::uint64_t> mainRowHashes;
+  std::vector<std::uint64_t> textureRowHashes;
 
   // Font for text rendering
-  sf::Font font;
-  bool fontLoaded;
+  std::shared_ptr<sf::Font> font;
+
+  // Set by loadResources(); headless maps skip loading images
+  bool hasResources = false;
 };
+
+template <typename Visitor>
+void Map::forEachSolid(const sf::FloatRect &bounds, Visitor &&visit) const {
+  int left, top, right, bottom;
+  if (!tileRange(bounds, left, top, right, bottom))
+    return;
+
+  for (int y = top; y <= bottom; ++y) {
+    for (int x = left; x <= right; ++x) {
+      if (!isSolidUnchecked(x, y))
+        continue;
+
+      sf::FloatRect wall({x * TILE_SIZE, y * TILE_SIZE},
+                         {TILE_SIZE, TILE_SIZE});
+      if constexpr (std::is_same_v<decltype(visit(wall)), bool>) {
+        if (!visit(wall))
+          return;
+      } else {
+        visit(wall);
+      }
+    }
+  }
+}
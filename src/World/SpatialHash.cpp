@@ -0,0 +1,108 @@
+#include "SpatialHash.hpp"
+#include "Map.hpp"
+
+SpatialHash::SpatialHash(int tilesPerCell)
+    : mCellSize(tilesPerCell * Map::TILE_SIZE) {}
+
+void SpatialHash::clear() {
+  mBodies.clear();
+  mEntries.clear();
+}
+
+void SpatialHash::insert(std::uint32_t id, const sf::FloatRect &bounds) {
+  Body body;
+  body.bounds = bounds;
+  body.id = id;
+  body.minX = cellCoord(bounds.position.x);
+  body.minY = cellCoord(bounds.position.y);
+  body.maxX = cellCoord(bounds.position.x + bounds.size.x);
+  body.maxY = cellCoord(bounds.position.y + bounds.size.y);
+  mBodies.push_back(body);
+}
+
+void SpatialHash::build() {
+  // Count cell entries first so the bucket table can be sized for them
+  std::size_t entryCount = 0;
+  for (const Body &body : mBodies) {
+    entryCount += static_cast<std::size_t>(body.maxX - body.minX + 1) *
+                  (body.maxY - body.minY + 1);
+  }
+
+  // About two buckets per entry keeps buckets short
+  std::size_t buckets = 16;
+  while (buckets < entryCount * 2)
+    buckets *= 2;
+  mBucketMask = buckets - 1;
+
+  // Counting sort: bucket sizes, prefix sums, then scatter
+  mStart.assign(buckets + 1, 0);
+  for (const Body &body : mBodies) {
+    for (int cy = body.minY; cy <= body.maxY; ++cy)
+      for (int cx = body.minX; cx <= body.maxX; ++cx)
+        ++mStart[bucketOf(cx, cy) + 1];
+  }
+  for (std::size_t b = 0; b < buckets; ++b)
+    mStart[b + 1] += mStart[b];
+
+  // Grow with headroom; resizing up from empty would reallocate at every
+  // new high-water mark
+  if (mEntries.capacity() < entryCount)
+    mEntries.reserve(entryCount + entryCount / 2);
+  mEntries.resize(entryCount);
+  for (std::uint32_t i = 0; i < mBodies.size(); ++i) {
+    const Body &body = mBodies[i];
+    for (int cy = body.minY; cy <= body.maxY; ++cy) {
+      for (int cx = body.minX; cx <= body.maxX; ++cx) {
+        // Fill each bucket back to front from its end offset
+        std::uint32_t &end = mStart[bucketOf(cx, cy) + 1];
+        mEntries[--end] = {i, cx, cy};
+      }
+    }
+  }
+  // The scatter moved each end offset down to its bucket's start, one
+  // slot to the right of where it belongs; shift them back
+  for (std::size_t b = 0; b < buckets; ++b)
+    mStart[b] = mStart[b + 1];
+  mStart[buckets] = static_cast<std::uint32_t>(entryCount);
+}
+
+bool SpatialHash::intersectRay(const sf::FloatRect &box, sf::Vector2f origin,
+                               sf::Vector2f direction, float maxT, float &t,
+                               sf::Vector2f &normal) {
+  float tNear = -std::numeric_limits<float>::infinity();
+  float tFar = std::numeric_limits<float>::infinity();
+  sf::Vector2f nearNormal;
+
+  const float start[2] = {origin.x, origin.y};
+  const float dir[2] = {direction.x, direction.y};
+  const float low[2] = {box.position.x, box.position.y};
+  const float high[2] = {box.position.x + box.size.x,
+                         box.position.y + box.size.y};
+
+  for (int axis = 0; axis < 2; ++axis) {
+    if (dir[axis] == 0.f) {
+      if (start[axis] <= low[axis] || start[axis] >= high[axis])
+        return false; // Parallel and outside the slab
+      continue;
+    }
+    float t0 = (low[axis] - start[axis]) / dir[axis];
+    float t1 = (high[axis] - start[axis]) / dir[axis];
+    float sign = -1.f; // Entering through the low face
+    if (t0 > t1) {
+      std::swap(t0, t1);
+      sign = 1.f;
+    }
+    if (t0 > tNear) {
+      tNear = t0;
+      nearNormal = axis == 0 ? sf::Vector2f(sign, 0.f)
+                             : sf::Vector2f(0.f, sign);
+    }
+    tFar = std::min(tFar, t1);
+  }
+
+  if (tNear < 0.f || tNear > tFar || tNear > maxT)
+    return false;
+  t = tNear;
+  normal = nearNormal;
+  return true;
+}
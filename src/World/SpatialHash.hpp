@@ -0,0 +1,243 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+// Broadphase for moving bodies: a uniform grid of square cells (a whole
+// number of map tiles wide), hashed into a flat bucket table so the grid
+// is unbounded and empty space costs nothing.
+//
+// The grid is rebuilt from scratch each tick: insert() every body, then
+// build() sorts the cell entries into buckets with a counting sort. Both
+// reuse their storage, so once warmed up a rebuild doesn't allocate.
+//
+// A body spanning several cells is stored in each of them, but every
+// query reports it once: only from the first cell (lowest x, then y)
+// shared by the body and the query range.
+class SpatialHash {
+public:
+  explicit SpatialHash(int tilesPerCell = 2);
+
+  float getCellSize() const { return mCellSize; }
+
+  // Removes all bodies (keeps the storage)
+  void clear();
+
+  // Adds a body; id is returned by the queries. Call build() afterwards.
+  void insert(std::uint32_t id, const sf::FloatRect &bounds);
+
+  // Sorts the inserted bodies into the grid
+  void build();
+
+  std::size_t size() const { return mBodies.size(); }
+
+  // Calls visit(std::uint32_t id) for each body overlapping the bounds.
+  // Bodies that only touch the bounds don't overlap. Return false from
+  // visit to stop early.
+  template <typename Visitor>
+  void query(const sf::FloatRect &bounds, Visitor &&visit) const;
+
+  // Calls visit(std::uint32_t a, std::uint32_t b) once for every pair of
+  // overlapping bodies
+  template <typename Visitor> void forEachPair(Visitor &&visit) const;
+
+  struct RayHit {
+    bool hit = false;
+    std::uint32_t id = 0;
+    float distance = 0.f; // Along the ray, in pixels
+    sf::Vector2f normal;  // Face of the body that was hit
+  };
+
+  // Nearest body hit by a ray within maxDistance pixels. direction need
+  // not be normalized. Bodies containing the origin are ignored (so an
+  // entity can cast from its own center). accept(id) can skip others.
+  RayHit raycast(sf::Vector2f origin, sf::Vector2f direction,
+                 float maxDistance) const {
+    return raycast(origin, direction, maxDistance,
+                   [](std::uint32_t) { return true; });
+  }
+  template <typename Filter>
+  RayHit raycast(sf::Vector2f origin, sf::Vector2f direction,
+                 float maxDistance, Filter &&accept) const;
+
+private:
+  struct Body {
+    sf::FloatRect bounds;
+    std::uint32_t id;
+    int minX, minY, maxX, maxY; // Cell range
+  };
+
+  struct Entry {
+    std::uint32_t body; // Index into mBodies
+    int cellX, cellY;
+  };
+
+  int cellCoord(float pixels) const {
+    return static_cast<int>(std::floor(pixels / mCellSize));
+  }
+
+  std::size_t bucketOf(int cellX, int cellY) const {
+    std::uint32_t hash = static_cast<std::uint32_t>(cellX) * 73856093u ^
+                         static_cast<std::uint32_t>(cellY) * 19349663u;
+    return hash & mBucketMask;
+  }
+
+  static bool overlaps(const sf::FloatRect &a, const sf::FloatRect &b) {
+    return a.position.x < b.position.x + b.size.x &&
+           b.position.x < a.position.x + a.size.x &&
+           a.position.y < b.position.y + b.size.y &&
+           b.position.y < a.position.y + a.size.y;
+  }
+
+  // Slab test. Returns false if the ray misses, starts inside or the hit
+  // is beyond maxT; otherwise the entry time and face normal.
+  static bool intersectRay(const sf::FloatRect &box, sf::Vector2f origin,
+                           sf::Vector2f direction, float maxT, float &t,
+                           sf::Vector2f &normal);
+
+  template <typename Visitor>
+  static bool call(Visitor &visit, std::uint32_t id) {
+    if constexpr (std::is_same_v<decltype(visit(id)), bool>) {
+      return visit(id);
+    } else {
+      visit(id);
+      return true;
+    }
+  }
+
+  float mCellSize;
+  std::vector<Body> mBodies;
+  std::vector<Entry> mEntries;       // Grouped by bucket after build()
+  std::vector<std::uint32_t> mStart; // Bucket b is [mStart[b], mStart[b+1])
+  std::size_t mBucketMask = 0;
+};
+
+template <typename Visitor>
+void SpatialHash::query(const sf::FloatRect &bounds, Visitor &&visit) const {
+  if (mBodies.empty())
+    return;
+
+  int minX = cellCoord(bounds.position.x);
+  int minY = cellCoord(bounds.position.y);
+  int maxX = cellCoord(bounds.position.x + bounds.size.x);
+  int maxY = cellCoord(bounds.position.y + bounds.size.y);
+
+  for (int cy = minY; cy <= maxY; ++cy) {
+    for (int cx = minX; cx <= maxX; ++cx) {
+      std::size_t bucket = bucketOf(cx, cy);
+      for (std::uint32_t e = mStart[bucket]; e < mStart[bucket + 1]; ++e) {
+        const Entry &entry = mEntries[e];
+        if (entry.cellX != cx || entry.cellY != cy)
+          continue;
+
+        const Body &body = mBodies[entry.body];
+        if (std::max(body.minX, minX) != cx ||
+            std::max(body.minY, minY) != cy)
+          continue; // Reported from another cell
+        if (!overlaps(body.bounds, bounds))
+          continue;
+        if (!call(visit, body.id))
+          return;
+      }
+    }
+  }
+}
+
+template <typename Visitor>
+void SpatialHash::forEachPair(Visitor &&visit) const {
+  const std::size_t buckets = mBucketMask + 1;
+  if (mBodies.empty())
+    return;
+
+  for (std::size_t bucket = 0; bucket < buckets; ++bucket) {
+    const std::uint32_t end = mStart[bucket + 1];
+    for (std::uint32_t i = mStart[bucket]; i < end; ++i) {
+      const Entry &first = mEntries[i];
+      const Body &a = mBodies[first.body];
+
+      for (std::uint32_t j = i + 1; j < end; ++j) {
+        const Entry &second = mEntries[j];
+        if (second.cellX != first.cellX || second.cellY != first.cellY)
+          continue;
+
+        const Body &b = mBodies[second.body];
+        if (std::max(a.minX, b.minX) != first.cellX ||
+            std::max(a.minY, b.minY) != first.cellY)
+          continue; // Reported from another cell
+        if (overlaps(a.bounds, b.bounds))
+          visit(a.id, b.id);
+      }
+    }
+  }
+}
+
+template <typename Filter>
+SpatialHash::RayHit SpatialHash::raycast(sf::Vector2f origin,
+                                         sf::Vector2f direction,
+                                         float maxDistance,
+                                         Filter &&accept) const {
+  RayHit best;
+  float length = std::sqrt(direction.x * direction.x +
+                           direction.y * direction.y);
+  if (mBodies.empty() || length <= 0.f || maxDistance <= 0.f)
+    return best;
+  direction = {direction.x / length, direction.y / length};
+
+  // Grid DDA: visit the cells along the ray in order, and stop as soon as
+  // the nearest hit so far lies before the cell being left
+  int cellX = cellCoord(origin.x);
+  int cellY = cellCoord(origin.y);
+  const int stepX = direction.x > 0.f ? 1 : (direction.x < 0.f ? -1 : 0);
+  const int stepY = direction.y > 0.f ? 1 : (direction.y < 0.f ? -1 : 0);
+  const float inf = std::numeric_limits<float>::infinity();
+
+  auto boundaryTime = [&](int cell, int step, float start, float dir) {
+    if (step == 0)
+      return inf;
+    float edge = (step > 0 ? cell + 1 : cell) * mCellSize;
+    return (edge - start) / dir;
+  };
+  float nextX = boundaryTime(cellX, stepX, origin.x, direction.x);
+  float nextY = boundaryTime(cellY, stepY, origin.y, direction.y);
+  const float deltaX = stepX ? mCellSize / std::abs(direction.x) : inf;
+  const float deltaY = stepY ? mCellSize / std::abs(direction.y) : inf;
+
+  float limit = maxDistance;
+  while (true) {
+    std::size_t bucket = bucketOf(cellX, cellY);
+    for (std::uint32_t e = mStart[bucket]; e < mStart[bucket + 1]; ++e) {
+      const Entry &entry = mEntries[e];
+      if (entry.cellX != cellX || entry.cellY != cellY)
+        continue;
+
+      const Body &body = mBodies[entry.body];
+      float t;
+      sf::Vector2f normal;
+      if (!intersectRay(body.bounds, origin, direction, limit, t, normal))
+        continue;
+      if (!accept(body.id))
+        continue;
+      best.hit = true;
+      best.id = body.id;
+      best.distance = t;
+      best.normal = normal;
+      limit = t;
+    }
+
+    float exit = std::min(nextX, nextY);
+    if (exit >= limit)
+      break;
+    if (nextX < nextY) {
+      cellX += stepX;
+      nextX += deltaX;
+    } else {
+      cellY += stepY;
+      nextY += deltaY;
+    }
+  }
+  return best;
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Flat, row-major storage for one tile layer.
+// Tiles are stored as compact Tiled GIDs (0 = empty) in a single contiguous
+// buffer, so walking a row touches consecutive memory.
+class TileGrid {
+public:
+  using TileId = std::uint16_t;
+  static constexpr TileId EMPTY = 0;
+
+  TileGrid() = default;
+  TileGrid(int width, int height, TileId fill = EMPTY) {
+    resize(width, height, fill);
+  }
+
+  void resize(int width, int height, TileId fill = EMPTY) {
+    mWidth = width > 0 ? width : 0;
+    mHeight = height > 0 ? height : 0;
+    mTiles.assign(static_cast<std::size_t>(mWidth) * mHeight, fill);
+  }
+
+  void clear() {
+    mWidth = 0;
+    mHeight = 0;
+    mTiles.clear();
+    mTiles.shrink_to_fit();
+  }
+
+  int getWidth() const { return mWidth; }
+  int getHeight() const { return mHeight; }
+  bool empty() const { return mTiles.empty(); }
+
+  bool inBounds(int x, int y) const {
+    return x >= 0 && y >= 0 && x < mWidth && y < mHeight;
+  }
+
+  // Bounds-checked access: out of range reads return EMPTY, writes are ignored
+  TileId get(int x, int y) const {
+    return inBounds(x, y) ? getUnchecked(x, y) : EMPTY;
+  }
+  void set(int x, int y, TileId id) {
+    if (inBounds(x, y))
+      setUnchecked(x, y, id);
+  }
+
+  // Unchecked access for hot loops that already clamped their range
+  TileId getUnchecked(int x, int y) const {
+    return mTiles[static_cast<std::size_t>(y) * mWidth + x];
+  }
+  void setUnchecked(int x, int y, TileId id) {
+    mTiles[static_cast<std::size_t>(y) * mWidth + x] = id;
+  }
+
+  // Pointer to the first tile of a row (rows are contiguous)
+  const TileId *row(int y) const {
+    return mTiles.data() + static_cast<std::size_t>(y) * mWidth;
+  }
+  TileId *row(int y) {
+    return mTiles.data() + static_cast<std::size_t>(y) * mWidth;
+  }
+
+  const TileId *data() const { return mTiles.data(); }
+  TileId *data() { return mTiles.data(); }
+  std::size_t size() const { return mTiles.size(); }
+
+  // Bytes used by the tile buffer
+  std::size_t memoryUsage() const { return mTiles.capacity() * sizeof(TileId); }
+
+private:
+  int mWidth = 0;
+  int mHeight = 0;
+  std::vector<TileId> mTiles;
+};
@@ -0,0 +1,213 @@
+#include "TileRenderer.hpp"
+#include "../Core/JobSystem.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+void TileRenderer::setTileset(const sf::Texture *texture,
+                              std::vector<sf::IntRect> tileRects) {
+  mTexture = texture;
+  mTileRects = std::move(tileRects);
+  markAllDirty();
+}
+
+void TileRenderer::reset(const TileGrid &grid, float tileSize) {
+  mTileSize = tileSize;
+  mChunksX = (grid.getWidth() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  mChunksY = (grid.getHeight() + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  mChunks.clear();
+  mChunks.resize(static_cast<size_t>(mChunksX) * mChunksY);
+}
+
+void TileRenderer::resetStreamed(int width, int height, float tileSize) {
+  mTileSize = tileSize;
+  mChunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  mChunksY = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  mChunks.clear();
+  mChunks.resize(static_cast<size_t>(mChunksX) * mChunksY);
+  for (Chunk &chunk : mChunks)
+    chunk.dirty = false;
+}
+
+void TileRenderer::swapMesh(int chunkX, int chunkY,
+                            sf::VertexArray &vertices) {
+  Chunk &chunk = mChunks[static_cast<size_t>(chunkY) * mChunksX + chunkX];
+  std::swap(chunk.vertices, vertices);
+}
+
+void TileRenderer::buildAll(const TileGrid &grid) {
+  // Chunks only touch their own vertices, so rows of them build in
+  // parallel
+  JobSystem::instance().parallelForWait(
+      static_cast<size_t>(mChunksY), 4, [&](size_t begin, size_t end) {
+        for (size_t cy = begin; cy < end; ++cy) {
+          for (int cx = 0; cx < mChunksX; ++cx) {
+            Chunk &chunk = mChunks[cy * mChunksX + cx];
+            if (chunk.dirty)
+              buildChunk(chunk, cx, static_cast<int>(cy), grid);
+          }
+        }
+      });
+}
+
+size_t TileRenderer::reuseUnchanged(const TileRenderer &previous,
+                                    const TileGrid &previousGrid,
+                                    const TileGrid &grid) {
+  if (previous.mTexture != mTexture || previous.mTileRects != mTileRects ||
+      previous.mTileSize != mTileSize || previous.mChunksX != mChunksX ||
+      previous.mChunksY != mChunksY ||
+      previousGrid.getWidth() != grid.getWidth() ||
+      previousGrid.getHeight() != grid.getHeight()) {
+    return 0;
+  }
+
+  std::atomic<size_t> reused{0};
+  JobSystem::instance().parallelForWait(
+      static_cast<size_t>(mChunksY), 4, [&](size_t begin, size_t end) {
+        size_t count = 0;
+        for (size_t cy = begin; cy < end; ++cy) {
+          for (int cx = 0; cx < mChunksX; ++cx) {
+            size_t index = cy * mChunksX + cx;
+            const Chunk &old = previous.mChunks[index];
+            if (old.dirty || !sameChunkTiles(cx, static_cast<int>(cy),
+                                             previousGrid, grid))
+              continue;
+            mChunks[index].vertices = old.vertices;
+            mChunks[index].dirty = false;
+            ++count;
+          }
+        }
+        reused.fetch_add(count);
+      });
+  return reused.load();
+}
+
+bool TileRenderer::sameChunkTiles(int chunkX, int chunkY, const TileGrid &a,
+                                  const TileGrid &b) {
+  int startX = chunkX * CHUNK_SIZE;
+  int startY = chunkY * CHUNK_SIZE;
+  int endX = std::min(startX + CHUNK_SIZE, a.getWidth());
+  int endY = std::min(startY + CHUNK_SIZE, a.getHeight());
+  size_t rowBytes =
+      static_cast<size_t>(endX - startX) * sizeof(TileGrid::TileId);
+
+  for (int y = startY; y < endY; ++y) {
+    if (std::memcmp(a.row(y) + startX, b.row(y) + startX, rowBytes) != 0)
+      return false;
+  }
+  return true;
+}
+
+void TileRenderer::markDirty(int tileX, int tileY) {
+  int chunkX = tileX / CHUNK_SIZE;
+  int chunkY = tileY / CHUNK_SIZE;
+  if (tileX < 0 || tileY < 0 || chunkX >= mChunksX || chunkY >= mChunksY)
+    return;
+  mChunks[static_cast<size_t>(chunkY) * mChunksX + chunkX].dirty = true;
+}
+
+void TileRenderer::markAllDirty() {
+  for (auto &chunk : mChunks)
+    chunk.dirty = true;
+}
+
+void TileRenderer::buildChunk(Chunk &chunk, int chunkX, int chunkY,
+                              const TileGrid &grid) {
+  chunk.vertices.clear();
+  chunk.dirty = false;
+
+  int startX = chunkX * CHUNK_SIZE;
+  int startY = chunkY * CHUNK_SIZE;
+  int endX = std::min(startX + CHUNK_SIZE, grid.getWidth());
+  int endY = std::min(startY + CHUNK_SIZE, grid.getHeight());
+  if (startX >= endX || startY >= endY)
+    return;
+
+  buildMesh(chunk.vertices, grid.row(startY) + startX, grid.getWidth(),
+            {startX, startY}, {endX - startX, endY - startY}, mTileRects,
+            mTileSize);
+}
+
+void TileRenderer::buildMesh(sf::VertexArray &out,
+                             const TileGrid::TileId *tiles, int stride,
+                             sf::Vector2i start, sf::Vector2i size,
+                             const std::vector<sf::IntRect> &tileRects,
+                             float tileSize) {
+  for (int y = 0; y < size.y; ++y) {
+    const TileGrid::TileId *row = tiles + static_cast<size_t>(y) * stride;
+    for (int x = 0; x < size.x; ++x) {
+      TileGrid::TileId id = row[x];
+      if (id >= tileRects.size())
+        continue;
+
+      const sf::IntRect &rect = tileRects[id];
+      if (rect.size.x <= 0 || rect.size.y <= 0)
+        continue;
+
+      // Two triangles per tile
+      float left = (start.x + x) * tileSize;
+      float top = (start.y + y) * tileSize;
+      float right = left + tileSize;
+      float bottom = top + tileSize;
+
+      float u0 = static_cast<float>(rect.position.x);
+      float v0 = static_cast<float>(rect.position.y);
+      float u1 = u0 + rect.size.x;
+      float v1 = v0 + rect.size.y;
+
+      out.append({{left, top}, sf::Color::White, {u0, v0}});
+      out.append({{right, top}, sf::Color::White, {u1, v0}});
+      out.append({{left, bottom}, sf::Color::White, {u0, v1}});
+      out.append({{left, bottom}, sf::Color::White, {u0, v1}});
+      out.append({{right, top}, sf::Color::White, {u1, v0}});
+      out.append({{right, bottom}, sf::Color::White, {u1, v1}});
+    }
+  }
+}
+
+sf::IntRect TileRenderer::getVisibleChunks(const sf::View &view) const {
+  sf::Vector2f viewCenter = view.getCenter();
+  sf::Vector2f viewSize = view.getSize();
+  float chunkPixels = CHUNK_SIZE * mTileSize;
+
+  int startX = std::max(
+      0, static_cast<int>((viewCenter.x - viewSize.x / 2.f) / chunkPixels));
+  int startY = std::max(
+      0, static_cast<int>((viewCenter.y - viewSize.y / 2.f) / chunkPixels));
+  int endX = std::min(
+      mChunksX,
+      static_cast<int>((viewCenter.x + viewSize.x / 2.f) / chunkPixels) + 1);
+  int endY = std::min(
+      mChunksY,
+      static_cast<int>((viewCenter.y + viewSize.y / 2.f) / chunkPixels) + 1);
+
+  return sf::IntRect({startX, startY},
+                     {std::max(0, endX - startX), std::max(0, endY - startY)});
+}
+
+void TileRenderer::render(sf::RenderTarget &target, const TileGrid &grid,
+                          const sf::IntRect &chunks) {
+  if (mChunks.empty() || !mTexture)
+    return;
+
+  int startX = std::max(0, chunks.position.x);
+  int startY = std::max(0, chunks.position.y);
+  int endX = std::min(mChunksX, chunks.position.x + chunks.size.x);
+  int endY = std::min(mChunksY, chunks.position.y + chunks.size.y);
+
+  sf::RenderStates states;
+  states.texture = mTexture;
+
+  for (int cy = startY; cy < endY; ++cy) {
+    for (int cx = startX; cx < endX; ++cx) {
+      Chunk &chunk = mChunks[static_cast<size_t>(cy) * mChunksX + cx];
+      if (chunk.dirty)
+        buildChunk(chunk, cx, cy, grid);
+
+      if (chunk.vertices.getVertexCount() > 0)
+        target.draw(chunk.vertices, states);
+    }
+  }
+}
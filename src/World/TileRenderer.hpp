@@ -0,0 +1,85 @@
+#pragma once
+#include "TileGrid.hpp"
+#include <SFML/Graphics.hpp>
+#include <vector>
+
+// Draws a tile layer as a set of prebuilt chunk meshes.
+// Each chunk is one vertex array of textured quads sampled from a single
+// tileset texture, so a frame costs one draw call per visible chunk instead
+// of one per tile. Chunks are rebuilt only after their tiles change.
+class TileRenderer {
+public:
+  // Chunk edge length in tiles
+  static constexpr int CHUNK_SIZE = 16;
+
+  // Sets the texture and the source rect for each tile ID.
+  // IDs without a rect (or with an empty one) are not drawn.
+  void setTileset(const sf::Texture *texture,
+                  std::vector<sf::IntRect> tileRects);
+
+  // Lays out chunks for a grid of the given size and marks them all dirty
+  void reset(const TileGrid &grid, float tileSize);
+
+  // Lays out empty, clean chunks for a width x height tile layer that has
+  // no grid: its meshes are handed in with swapMesh() (see ChunkStreamer)
+  void resetStreamed(int width, int height, float tileSize);
+
+  // Exchanges a chunk's mesh with vertices
+  void swapMesh(int chunkX, int chunkY, sf::VertexArray &vertices);
+
+  const std::vector<sf::IntRect> &getTileRects() const { return mTileRects; }
+
+  // Appends two triangles per drawable tile of a block of tiles to out.
+  // tiles points at the block's first tile, which is at start in the
+  // layer; rows are stride tiles apart.
+  static void buildMesh(sf::VertexArray &out, const TileGrid::TileId *tiles,
+                        int stride, sf::Vector2i start, sf::Vector2i size,
+                        const std::vector<sf::IntRect> &tileRects,
+                        float tileSize);
+
+  // Builds every dirty chunk now instead of on first draw, spread over the
+  // job system. Only touches vertex data, so it is safe on a loader thread.
+  void buildAll(const TileGrid &grid);
+
+  // Copies the built meshes of previous (a renderer laid out the same way,
+  // with the same tileset) for every chunk whose tiles are equal in both
+  // grids, and marks them clean. Returns how many chunks were reused; if
+  // the layouts differ, none are.
+  size_t reuseUnchanged(const TileRenderer &previous,
+                        const TileGrid &previousGrid, const TileGrid &grid);
+
+  // Marks the chunk containing a tile for rebuild
+  void markDirty(int tileX, int tileY);
+  void markAllDirty();
+
+  // Range of chunks (in chunk coordinates) overlapping the view
+  sf::IntRect getVisibleChunks(const sf::View &view) const;
+
+  // Draws the chunks overlapping the target's current view,
+  // rebuilding any dirty ones from the grid first
+  void render(sf::RenderTarget &target, const TileGrid &grid) {
+    render(target, grid, getVisibleChunks(target.getView()));
+  }
+
+  // Same, for a chunk range chosen by the caller
+  void render(sf::RenderTarget &target, const TileGrid &grid,
+              const sf::IntRect &chunks);
+
+private:
+  struct Chunk {
+    sf::VertexArray vertices{sf::PrimitiveType::Triangles};
+    bool dirty = true;
+  };
+
+  void buildChunk(Chunk &chunk, int chunkX, int chunkY, const TileGrid &grid);
+  static bool sameChunkTiles(int chunkX, int chunkY, const TileGrid &a,
+                             const TileGrid &b);
+
+  const sf::Texture *mTexture = nullptr;
+  std::vector<sf::IntRect> mTileRects;
+
+  std::vector<Chunk> mChunks;
+  int mChunksX = 0;
+  int mChunksY = 0;
+  float mTileSize = 32.f;
+};
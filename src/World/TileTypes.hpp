@@ -0,0 +1,76 @@
+#pragma once
+#include "TileGrid.hpp"
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <vector>
+
+// What each tile does, compiled from boolean <properties> of the tiles in
+// a map's tilesets ("solid", "oneway", "hazard", "spawn", "finish" and
+// "render"), so new tile types need no engine change.
+//
+// Lookups index a flat table with an entry for every possible TileId
+// (flip bits are already stripped when layers are decoded), so testing a
+// tile is one load and a bit test, without a bounds check or a branch on
+// the ID.
+class TileTypes {
+public:
+  static constexpr std::uint8_t SOLID = 1 << 0;   // Blocks on every side
+  static constexpr std::uint8_t ONE_WAY = 1 << 1; // Blocks from above only
+  static constexpr std::uint8_t HAZARD = 1 << 2;  // Sends the player back
+  static constexpr std::uint8_t SPAWN = 1 << 3;   // Player start
+  static constexpr std::uint8_t FINISH = 1 << 4;  // Level goal
+  static constexpr std::uint8_t RENDER = 1 << 5;  // Drawn from the tileset
+
+  // One tile with properties; source is its rect in the tileset image
+  struct Entry {
+    TileGrid::TileId id;
+    std::uint8_t flags;
+    sf::IntRect source;
+    bool operator==(const Entry &) const = default;
+  };
+
+  TileTypes() : mFlags(std::size_t{1} << 16, 0) {}
+
+  void clear() {
+    for (const Entry &entry : mEntries)
+      mFlags[entry.id] = 0;
+    mEntries.clear();
+  }
+
+  // A later entry for the same ID replaces the earlier one's flags
+  void add(const Entry &entry) {
+    mFlags[entry.id] = entry.flags;
+    mEntries.push_back(entry);
+  }
+
+  std::uint8_t get(TileGrid::TileId id) const { return mFlags[id]; }
+  bool has(TileGrid::TileId id, std::uint8_t flag) const {
+    return (mFlags[id] & flag) != 0;
+  }
+
+  bool empty() const { return mEntries.empty(); }
+  const std::vector<Entry> &getEntries() const { return mEntries; }
+
+  // Source rects of the RENDER tiles, indexed by ID and offset by origin
+  // (where the tileset image sits in its texture); empty rects elsewhere
+  std::vector<sf::IntRect> getRenderRects(sf::Vector2i origin) const {
+    std::vector<sf::IntRect> rects;
+    for (const Entry &entry : mEntries) {
+      if (!(entry.flags & RENDER))
+        continue;
+      if (entry.id >= rects.size())
+        rects.resize(entry.id + 1);
+      rects[entry.id] =
+          sf::IntRect(entry.source.position + origin, entry.source.size);
+    }
+    return rects;
+  }
+
+  bool operator==(const TileTypes &other) const {
+    return mEntries == other.mEntries;
+  }
+
+private:
+  std::vector<std::uint8_t> mFlags; // Per TileId
+  std::vector<Entry> mEntries;      // Only the IDs with properties
+};
@@ -1,7 +1,100 @@
+#include "Core/JobSystem.hpp"
 #include "Game.hpp"
+#include <charconv>
+#include <iostream>
+#include <string>
+#include <string_view>
 
-int main() {
-  Game game;
-  game.run();
-  return 0;
+static void printUsage() {
+  std::cout << "Usage: JourneyToTheClouds [options]\n"
+            << "  --level <file>   Map to load (default: tutorial.tmx)\n"
+            << "  --headless       Simulate without a window\n"
+            << "  --ticks <n>      Ticks to simulate in headless mode\n"
+            << "  --record <file>  Record input and state hashes per tick\n"
+            << "  --replay <file>  Play back and verify a recording\n"
+            << "  --pacing <mode>  vsync (default), uncapped, or a frame\n"
+            << "                   cap such as 144 (sleep + spin limiter)\n"
+            << "  --threaded       Run the simulation on its own thread\n"
+            << "  --watch          Reload the level whenever it is saved\n"
+            << "  --stream-radius <n>\n"
+            << "                   Infinite maps: chunks kept loaded beyond\n"
+            << "                   the view (default: 4)\n"
+            << "  --stream-budget <MB>\n"
+            << "                   Infinite maps: memory for loaded chunks\n"
+            << "                   (default: 32)\n"
+            << "  --jobs <n>       Threads for parallel engine work\n"
+            << "                   (default: one per hardware thread)\n";
+}
+
+// The whole of text as an integer above zero
+static bool parsePositive(std::string_view text, int &value) {
+  int parsed = 0;
+  const char *end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, parsed);
+  if (result.ec != std::errc() || result.ptr != end || parsed <= 0)
+    return false;
+  value = parsed;
+  return true;
+}
+
+static int invalidValue(const std::string &option, std::string_view value) {
+  std::cerr << "Invalid value for " << option << ": \"" << value << "\""
+            << std::endl;
+  printUsage();
+  return 1;
+}
+
+int main(int argc, char *argv[]) {
+  GameOptions options;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+
+    if (arg == "--headless") {
+      options.headless = true;
+    } else if (arg == "--threaded") {
+      options.threaded = true;
+    } else if (arg == "--watch") {
+      options.watchLevel = true;
+    } else if (arg == "--level" && hasValue) {
+      options.levelPath = argv[++i];
+    } else if (arg == "--stream-radius" && hasValue) {
+      if (!parsePositive(argv[++i], options.streamRadius))
+        return invalidValue(arg, argv[i]);
+    } else if (arg == "--stream-budget" && hasValue) {
+      if (!parsePositive(argv[++i], options.streamBudgetMB))
+        return invalidValue(arg, argv[i]);
+    } else if (arg == "--ticks" && hasValue) {
+      if (!parsePositive(argv[++i], options.ticks))
+        return invalidValue(arg, argv[i]);
+    } else if (arg == "--record" && hasValue) {
+      options.recordPath = argv[++i];
+    } else if (arg == "--replay" && hasValue) {
+      options.replayPath = argv[++i];
+    } else if (arg == "--jobs" && hasValue) {
+      // The calling thread helps, so n threads means n - 1 workers
+      int threads = 0;
+      if (!parsePositive(argv[++i], threads))
+        return invalidValue(arg, argv[i]);
+      JobSystem::setInstanceWorkers(threads - 1);
+    } else if (arg == "--pacing" && hasValue) {
+      std::string mode = argv[++i];
+      if (mode == "vsync") {
+        options.pacing = FramePacing::VSync;
+      } else if (mode == "uncapped") {
+        options.pacing = FramePacing::Uncapped;
+      } else if (parsePositive(mode, options.frameLimit)) {
+        options.pacing = FramePacing::Limited;
+      } else {
+        return invalidValue(arg, mode);
+      }
+    } else {
+      printUsage();
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+
+  Game game(options);
+  return game.run();
 }
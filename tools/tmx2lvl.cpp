@@ -0,0 +1,49 @@
+// Converts Tiled maps (.tmx) into precompiled binary levels (.lvl).
+//
+// Usage: tmx2lvl <input.tmx> [output.lvl]
+//        tmx2lvl --all <input.tmx>... (each written next to its input)
+
+#include "World/Map.hpp"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+static std::string binaryPath(const std::string &tmxPath) {
+  return tmxPath.substr(0, tmxPath.find_last_of('.')) + ".lvl";
+}
+
+static bool convert(const std::string &input, const std::string &output) {
+  Map map;
+  if (!map.loadFromFile(input)) {
+    std::cerr << "tmx2lvl: failed to load " << input << std::endl;
+    return false;
+  }
+  if (!map.saveBinary(output)) {
+    std::cerr << "tmx2lvl: failed to write " << output << std::endl;
+    return false;
+  }
+
+  std::cout << input << " -> " << output << std::endl;
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<std::string> args(argv + 1, argv + argc);
+
+  if (args.size() >= 2 && args[0] == "--all") {
+    bool ok = true;
+    for (size_t i = 1; i < args.size(); ++i)
+      ok = convert(args[i], binaryPath(args[i])) && ok;
+    return ok ? 0 : 1;
+  }
+
+  if (args.empty() || args.size() > 2 || args[0].rfind("--", 0) == 0) {
+    std::cerr << "Usage: tmx2lvl <input.tmx> [output.lvl]\n"
+              << "       tmx2lvl --all <input.tmx>..." << std::endl;
+    return 1;
+  }
+
+  std::string output = args.size() == 2 ? args[1] : binaryPath(args[0]);
+  return convert(args[0], output) ? 0 : 1;
+}